@@ -0,0 +1,199 @@
+#ifndef AKIMA_H
+#define AKIMA_H
+
+#include "interpolation_base.h"
+#include "cubic_eval.h"
+#include "instrumentation.h"
+#include "segment_search.h"
+
+#include <vector>
+#include <cassert>
+#include <cmath>
+
+
+//Akima interpolation and its modified version (makima).
+//Derivatives are calculated locally from the neighbouring secant slopes,
+//so the fit is O(n) without a linear solve, like in pchip_t
+template <class T>
+class akima_t : public interpolation_base_t
+{
+public:
+  enum class kind_t { original, modified };
+
+  explicit akima_t(kind_t a_kind = kind_t::original);
+  virtual ~akima_t() override;
+  virtual void set_points(const T *a_x, const T *a_y, size_t a_length) override;
+  virtual T operator()(T a_x) override;
+  virtual void calc_array(const T* a_x, T* a_y, size_t a_count) override;
+  virtual interpolation_derivs_t calc_derivs(T a_x) override;
+  virtual void calc_derivs_array(const T* a_x, T* a_value, T* a_first,
+    T* a_second, size_t a_count) override;
+private:
+  kind_t m_kind;
+  size_t m_nodes_count;
+  std::vector<T> m_x;
+  std::vector<T> m_y;
+  std::vector<T> m_derivatives;
+
+  std::vector<T> m_c2;
+  std::vector<T> m_c3;
+
+  //Secant slopes with two extra values on each side
+  std::vector<T> m_slopes;
+
+  void akima_set();
+  T calc_segment(size_t a_interval_num, T a_x) const;
+};
+
+template <class T>
+akima_t<T>::akima_t(kind_t a_kind) :
+  m_kind(a_kind),
+  m_nodes_count(0),
+  m_x(),
+  m_y(),
+  m_derivatives(),
+  m_c2(),
+  m_c3(),
+  m_slopes()
+{
+}
+
+template <class T>
+akima_t<T>::~akima_t()
+{
+}
+
+template <class T>
+void akima_t<T>::set_points(const T* a_x, const T* a_y, size_t a_length)
+{
+  SPLINES_SCOPED_TIMER(itm_set_points);
+  SPLINES_COUNT(ic_fits);
+  assert(a_length >= 2);
+  for (size_t i = 1; i < a_length; i++) {
+    assert(a_x[i] > a_x[i - 1]);
+  }
+
+  if (m_nodes_count != a_length) {
+    m_nodes_count = a_length;
+    m_x.resize(m_nodes_count);
+    m_y.resize(m_nodes_count);
+    m_derivatives.resize(m_nodes_count);
+    m_c2.resize(m_nodes_count);
+    m_c3.resize(m_nodes_count);
+    m_slopes.resize(m_nodes_count + 3);
+  }
+
+  std::copy(a_x, a_x + a_length, m_x.begin());
+  std::copy(a_y, a_y + a_length, m_y.begin());
+
+  akima_set();
+}
+
+template <class T>
+void akima_t<T>::akima_set()
+{
+  const size_t n = m_nodes_count;
+  //m_slopes[i + 2] is the slope of the interval [x[i], x[i+1]]
+  T* slope = m_slopes.data() + 2;
+  for (size_t i = 0; i < n - 1; i++) {
+    slope[i] = (m_y[i+1] - m_y[i]) / (m_x[i+1] - m_x[i]);
+  }
+
+  if (n == 2) {
+    //Only one interval, use linear interpolation
+    m_derivatives[0] = slope[0];
+    m_derivatives[1] = slope[0];
+  } else {
+    //Extra slopes are extrapolated quadratically, as in the original paper
+    slope[-1] = 2 * slope[0] - slope[1];
+    slope[-2] = 2 * slope[-1] - slope[0];
+    slope[n - 1] = 2 * slope[n - 2] - slope[n - 3];
+    slope[n] = 2 * slope[n - 1] - slope[n - 2];
+
+    for (size_t i = 0; i < n; i++) {
+      T s_ll = slope[static_cast<int>(i) - 2];
+      T s_l = slope[static_cast<int>(i) - 1];
+      T s_r = slope[i];
+      T s_rr = slope[i + 1];
+
+      T w_l = std::fabs(s_rr - s_r);
+      T w_r = std::fabs(s_l - s_ll);
+      if (m_kind == kind_t::modified) {
+        //Extra terms suppress overshoot on flat parts and
+        //for equal-slope neighbours
+        w_l += std::fabs(s_rr + s_r) / 2;
+        w_r += std::fabs(s_l + s_ll) / 2;
+      }
+      if (w_l + w_r > 0) {
+        m_derivatives[i] = (w_l * s_l + w_r * s_r) / (w_l + w_r);
+      } else {
+        m_derivatives[i] = (s_l + s_r) / 2;
+      }
+    }
+  }
+
+  for (size_t i = 0; i < n - 1; i++) {
+    T h = m_x[i+1] - m_x[i];
+    T delta1 = (m_derivatives[i] - slope[i]) / h;
+    T delta2 = (m_derivatives[i+1] - slope[i]) / h;
+    m_c2[i] = -(delta1 + delta1 + delta2);
+    m_c3[i] = (delta1 + delta2) / h;
+  }
+}
+
+template <class T>
+T akima_t<T>::calc_segment(size_t a_interval_num, T a_x) const
+{
+  T x = a_x - m_x[a_interval_num];
+  T y = m_y[a_interval_num] + x * (m_derivatives[a_interval_num] +
+    x * (m_c2[a_interval_num] + x * m_c3[a_interval_num]));
+  return y;
+}
+
+template <class T>
+T akima_t<T>::operator()(T a_x)
+{
+  SPLINES_COUNT(ic_evaluations);
+  assert(m_nodes_count);
+  return calc_segment(find_segment(m_x, a_x), a_x);
+}
+
+template <class T>
+void akima_t<T>::calc_array(const T* a_x, T* a_y, size_t a_count)
+{
+  SPLINES_COUNT_N(ic_evaluations, a_count);
+  assert(m_nodes_count);
+  size_t interval_num = 0;
+  for (size_t i = 0; i < a_count; i++) {
+    interval_num = find_segment(m_x, a_x[i], interval_num);
+    a_y[i] = calc_segment(interval_num, a_x[i]);
+  }
+}
+
+template <class T>
+interpolation_derivs_t akima_t<T>::calc_derivs(T a_x)
+{
+  assert(m_nodes_count);
+  size_t interval_num = find_segment(m_x, a_x);
+  T x = a_x - m_x[interval_num];
+  T c1 = m_derivatives[interval_num];
+  T c2 = m_c2[interval_num];
+  T c3 = m_c3[interval_num];
+  interpolation_derivs_t derivs;
+  derivs.value = m_y[interval_num] + x * (c1 + x * (c2 + x * c3));
+  derivs.first = c1 + x * (2 * c2 + x * 3 * c3);
+  derivs.second = 2 * c2 + 6 * c3 * x;
+  return derivs;
+}
+
+template <class T>
+void akima_t<T>::calc_derivs_array(const T* a_x, T* a_value, T* a_first,
+  T* a_second, size_t a_count)
+{
+  assert(m_nodes_count);
+  calc_cubic_derivs_array(m_x, m_y.data(), m_derivatives.data(), m_c2.data(),
+    m_c3.data(), a_x, a_value, a_first, a_second, a_count);
+}
+
+
+#endif // AKIMA_H
@@ -0,0 +1,396 @@
+#include "bspline_fit.h"
+#include "segment_search.h"
+#include "instrumentation.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace tk {
+
+namespace {
+
+const int degree=3;
+const size_t chunk_size=256;
+
+// the 4 cubic basis functions N_{k-3}..N_k which are non-zero in the knot
+// span k, u[k] <= x < u[k+1] (Piegl, Tiller "The NURBS Book", A2.2)
+void basis_functions(const double* u, size_t k, double x, double* N)
+{
+    double left[degree+1], right[degree+1];
+    N[0]=1.0;
+    for(int j=1; j<=degree; j++) {
+        left[j]=x-u[k+1-j];
+        right[j]=u[k+j]-x;
+        double saved=0.0;
+        for(int r=0; r<j; r++) {
+            double temp=N[r]/(right[r+1]+left[j-r]);
+            N[r]=saved+right[r+1]*temp;
+            saved=left[j-r]*temp;
+        }
+        N[j]=saved;
+    }
+}
+
+// monomial coefficients P[r][a] of N_{k-3+a}(u[k] + s*(u[k+1]-u[k])),
+// s in [0,1], from the values in s=0,1/3,2/3,1 by divided differences
+void interval_basis(const double* u, size_t k, double P[degree+1][degree+1])
+{
+    double s[degree+1], values[degree+1][degree+1];
+    for(int j=0; j<=degree; j++) {
+        s[j]=double(j)/degree;
+        basis_functions(u, k, u[k]+s[j]*(u[k+1]-u[k]), values[j]);
+    }
+    for(int a=0; a<=degree; a++) {
+        double c[degree+1];
+        for(int j=0; j<=degree; j++) {
+            c[j]=values[j][a];
+        }
+        for(int r=1; r<=degree; r++) {
+            for(int j=degree; j>=r; j--) {
+                c[j]=(c[j]-c[j-1])/(s[j]-s[j-r]);
+            }
+        }
+        // Newton form to monomials, p = p*(s-s_j) + c_j
+        double p[degree+1]={};
+        p[0]=c[degree];
+        for(int j=degree-1; j>=0; j--) {
+            for(int r=degree; r>0; r--) {
+                p[r]=p[r-1]-s[j]*p[r];
+            }
+            p[0]=c[j]-s[j]*p[0];
+        }
+        for(int r=0; r<=degree; r++) {
+            P[r][a]=p[r];
+        }
+    }
+}
+
+// de Boor algorithm for a spline of degree p with knots u and
+// coefficients c in the knot span k
+double de_boor_span(int p, const double* u, const double* c, size_t k, double x)
+{
+    double d[degree+1];
+    for(int j=0; j<=p; j++) {
+        d[j]=c[k-p+j];
+    }
+    for(int r=1; r<=p; r++) {
+        for(int j=p; j>=r; j--) {
+            double alpha=(x-u[k-p+j])/(u[k+1+j-r]-u[k-p+j]);
+            d[j]=(1.0-alpha)*d[j-1]+alpha*d[j];
+        }
+    }
+    return d[p];
+}
+
+// coefficients of the derivative, a spline of degree p-1 on the
+// knots u+1 without the first and the last knot
+void derivative_coeffs(int p, const double* u, const std::vector<double>& c,
+                       std::vector<double>& dc)
+{
+    dc.resize(c.size()-1);
+    for(size_t j=0; j<dc.size(); j++) {
+        dc[j]=p*(c[j+1]-c[j])/(u[j+p+1]-u[j+1]);
+    }
+}
+
+} // namespace
+
+
+bspline_fit::bspline_fit(): m_breakpoints_set(false), m_breakpoint_count(0)
+{
+}
+
+bspline_fit::~bspline_fit()
+{
+}
+
+void bspline_fit::set_breakpoints(const double* x, size_t count)
+{
+    assert(count>1);
+    for(size_t i=0; i+1<count; i++) {
+        assert(x[i]<x[i+1]);
+    }
+    m_breakpoints.assign(x, x+count);
+    m_breakpoints_set=true;
+}
+
+void bspline_fit::set_breakpoint_count(size_t count)
+{
+    assert(count>1);
+    m_breakpoint_count=count;
+    m_breakpoints_set=false;
+}
+
+void bspline_fit::make_breakpoints(const double* a_x, size_t a_size)
+{
+    if(m_breakpoints_set) {
+        return;
+    }
+    size_t m=m_breakpoint_count;
+    if(m==0) {
+        m=std::min<size_t>(std::max<size_t>(a_size/4, 2), 1024);
+    }
+    double x_min=a_x[0], x_max=a_x[0];
+    for(size_t i=1; i<a_size; i++) {
+        x_min=std::min(x_min, a_x[i]);
+        x_max=std::max(x_max, a_x[i]);
+    }
+    assert(x_min<x_max);
+    m_breakpoints.resize(m);
+    double step=(x_max-x_min)/double(m-1);
+    for(size_t i=0; i+1<m; i++) {
+        m_breakpoints[i]=x_min+step*double(i);
+    }
+    m_breakpoints[m-1]=x_max;
+}
+
+void bspline_fit::set_points(const double* a_x, const double* a_y, size_t a_size)
+{
+    SPLINES_SCOPED_TIMER(itm_set_points);
+    SPLINES_COUNT(ic_fits);
+    assert(a_size > 1);
+    make_breakpoints(a_x, a_size);
+
+    // clamped knot vector, t_0 and t_{m-1} are repeated degree+1 times,
+    // interval i=[t_i, t_{i+1}) is the knot span i+degree
+    const size_t m=m_breakpoints.size();
+    const size_t dim=m+degree-1;
+    m_knots.resize(m+2*degree);
+    std::fill(m_knots.begin(), m_knots.begin()+degree, m_breakpoints[0]);
+    std::copy(m_breakpoints.begin(), m_breakpoints.end(), m_knots.begin()+degree);
+    std::fill(m_knots.end()-degree, m_knots.end(), m_breakpoints[m-1]);
+
+    // normal equations, a point of interval i touches the coefficients
+    // i..i+3 only. The basis functions are cubics in s=(x-t_i)/(t_{i+1}-t_i),
+    // so the points of an interval are summed into the moments sum(s^r) and
+    // sum(y*s^r), which become its 4x4 block when the interval changes.
+    // The matrix still holds the LU factors of the previous fit
+    m_system.resize(int(dim), degree, degree);
+    for(int j=0; j<int(dim); j++) {
+        for(int b=std::max(j-degree, 0); b<=std::min(j+degree, int(dim)-1); b++) {
+            m_system(j,b)=0.0;
+        }
+    }
+    std::pmr::vector<double> rhs(dim, 0.0);
+    double moments[2*degree+1]={};
+    double y_moments[degree+1]={};
+    size_t block_idx=0;
+    bool block_used=false;
+    double block_x=0.0, block_scale=0.0;
+    auto flush_block=[&]() {
+        double P[degree+1][degree+1], Q[degree+1][degree+1];
+        interval_basis(m_knots.data(), block_idx+degree, P);
+        for(int k=0; k<=degree; k++) {
+            for(int b=0; b<=degree; b++) {
+                Q[k][b]=0.0;
+                for(int l=0; l<=degree; l++) {
+                    Q[k][b]+=P[l][b]*moments[k+l];
+                }
+            }
+        }
+        for(int a=0; a<=degree; a++) {
+            for(int b=0; b<=degree; b++) {
+                double v=0.0;
+                for(int k=0; k<=degree; k++) {
+                    v+=P[k][a]*Q[k][b];
+                }
+                m_system(int(block_idx)+a, int(block_idx)+b)+=v;
+            }
+            double v=0.0;
+            for(int k=0; k<=degree; k++) {
+                v+=P[k][a]*y_moments[k];
+            }
+            rhs[block_idx+a]+=v;
+        }
+        std::fill(moments, moments+2*degree+1, 0.0);
+        std::fill(y_moments, y_moments+degree+1, 0.0);
+        block_used=false;
+    };
+    size_t idx=0;
+    for(size_t i=0; i<a_size; i++) {
+        double x=a_x[i];
+        if(x<m_breakpoints[0] || x>m_breakpoints[m-1]) {
+            continue;
+        }
+        idx=find_segment(m_breakpoints, x, idx);
+        if(!block_used || idx!=block_idx) {
+            if(block_used) {
+                flush_block();
+            }
+            block_idx=idx;
+            block_used=true;
+            block_x=m_breakpoints[idx];
+            block_scale=1.0/(m_breakpoints[idx+1]-m_breakpoints[idx]);
+        }
+        double s=(x-block_x)*block_scale;
+        double s2=s*s, s3=s2*s;
+        double y=a_y[i];
+        moments[0]+=1.0;
+        moments[1]+=s;
+        moments[2]+=s2;
+        moments[3]+=s3;
+        moments[4]+=s2*s2;
+        moments[5]+=s2*s3;
+        moments[6]+=s3*s3;
+        y_moments[0]+=y;
+        y_moments[1]+=y*s;
+        y_moments[2]+=y*s2;
+        y_moments[3]+=y*s3;
+    }
+    if(block_used) {
+        flush_block();
+    }
+
+    // intervals without points leave the matrix singular, a second
+    // difference penalty far below the data terms fills such gaps smoothly
+    double trace=0.0;
+    for(size_t j=0; j<dim; j++) {
+        trace+=m_system(int(j), int(j));
+    }
+    assert(trace>0.0);
+    const double penalty=1e-10*trace/double(dim);
+    const double weights[3]={1.0, -2.0, 1.0};
+    for(size_t j=0; j+2<dim; j++) {
+        for(int a=0; a<3; a++) {
+            for(int b=0; b<3; b++) {
+                m_system(int(j)+a, int(j)+b)+=penalty*weights[a]*weights[b];
+            }
+        }
+    }
+
+    // symmetric positive definite, no pivoting needed
+    std::pmr::vector<double> coeffs=m_system.lu_solve(rhs);
+    m_coeffs.assign(coeffs.begin(), coeffs.end());
+    to_piecewise();
+}
+
+void bspline_fit::to_piecewise()
+{
+    // Taylor coefficients of every interval from de Boor on the
+    // derivative splines, each of them drops the first knot
+    const size_t m=m_breakpoints.size();
+    const double* u0=m_knots.data();
+    const double* u1=u0+1;
+    const double* u2=u0+2;
+    std::vector<double> d1, d2, d3;
+    derivative_coeffs(3, u0, m_coeffs, d1);
+    derivative_coeffs(2, u1, d1, d2);
+    derivative_coeffs(1, u2, d2, d3);
+
+    m_curve.knots=m_breakpoints;
+    m_curve.coeffs.resize((m+1)*piecewise_cubic_t::coeffs_per_segment);
+    m_curve.period=0.0;
+    double* c=m_curve.coeffs.data();
+    for(size_t i=0; i+1<m; i++) {
+        double x=m_breakpoints[i];
+        c+=piecewise_cubic_t::coeffs_per_segment;
+        c[0]=de_boor_span(3, u0, m_coeffs.data(), i+3, x);
+        c[1]=de_boor_span(2, u1, d1.data(), i+2, x);
+        c[2]=de_boor_span(1, u2, d2.data(), i+1, x)/2.0;
+        c[3]=d3[i]/6.0;
+    }
+    // linear extrapolation on both sides
+    c=m_curve.coeffs.data();
+    c[0]=c[4]; c[1]=c[5]; c[2]=0.0; c[3]=0.0;
+    double x=m_breakpoints[m-1];
+    c+=m*piecewise_cubic_t::coeffs_per_segment;
+    c[0]=de_boor_span(3, u0, m_coeffs.data(), m+1, x);
+    c[1]=de_boor_span(2, u1, d1.data(), m, x);
+    c[2]=0.0;
+    c[3]=0.0;
+}
+
+double bspline_fit::de_boor(double x) const
+{
+    assert(!m_coeffs.empty());
+    const size_t m=m_breakpoints.size();
+    x=std::min(std::max(x, m_breakpoints[0]), m_breakpoints[m-1]);
+    size_t idx=find_segment(m_breakpoints, x);
+    return de_boor_span(degree, m_knots.data(), m_coeffs.data(), idx+degree, x);
+}
+
+double bspline_fit::operator() (double x)
+{
+    double y;
+    calc_array(&x, &y, 1);
+    return y;
+}
+
+void bspline_fit::calc_array(const double* a_x, double* a_y, size_t a_count)
+{
+    SPLINES_COUNT_N(ic_evaluations, a_count);
+    // segments of a whole chunk first, then a branch-free Horner loop
+    const size_t m=m_breakpoints.size();
+    const double* coeffs=m_curve.coeffs.data();
+    size_t segments[chunk_size];
+    double h[chunk_size];
+    size_t idx=0;
+    for(size_t begin=0; begin<a_count; begin+=chunk_size) {
+        size_t count=std::min(chunk_size, a_count-begin);
+        for(size_t k=0; k<count; k++) {
+            double x=a_x[begin+k];
+            idx=find_segment(m_breakpoints, x, idx);
+            size_t segment=(x<m_breakpoints[0]) ? 0 : (x>m_breakpoints[m-1]) ? m : idx+1;
+            segments[k]=segment*piecewise_cubic_t::coeffs_per_segment;
+            h[k]=x-m_breakpoints[(segment==0) ? 0 : segment-1];
+        }
+        for(size_t k=0; k<count; k++) {
+            const double* c=coeffs+segments[k];
+            double t=h[k];
+            a_y[begin+k]=c[0] + t*(c[1] + t*(c[2] + t*c[3]));
+        }
+    }
+}
+
+interpolation_derivs_t bspline_fit::calc_derivs(double x)
+{
+    interpolation_derivs_t derivs;
+    calc_derivs_array(&x, &derivs.value, &derivs.first, &derivs.second, 1);
+    return derivs;
+}
+
+void bspline_fit::calc_derivs_array(const double* a_x, double* a_value,
+                                    double* a_first, double* a_second,
+                                    size_t a_count)
+{
+    const size_t m=m_breakpoints.size();
+    const double* coeffs=m_curve.coeffs.data();
+    size_t segments[chunk_size];
+    double h[chunk_size];
+    size_t idx=0;
+    for(size_t begin=0; begin<a_count; begin+=chunk_size) {
+        size_t count=std::min(chunk_size, a_count-begin);
+        for(size_t k=0; k<count; k++) {
+            double x=a_x[begin+k];
+            idx=find_segment(m_breakpoints, x, idx);
+            size_t segment=(x<m_breakpoints[0]) ? 0 : (x>m_breakpoints[m-1]) ? m : idx+1;
+            segments[k]=segment*piecewise_cubic_t::coeffs_per_segment;
+            h[k]=x-m_breakpoints[(segment==0) ? 0 : segment-1];
+        }
+        for(size_t k=0; k<count; k++) {
+            const double* c=coeffs+segments[k];
+            double t=h[k];
+            a_value[begin+k]=c[0] + t*(c[1] + t*(c[2] + t*c[3]));
+            a_first[begin+k]=c[1] + t*(2.0*c[2] + 3.0*c[3]*t);
+            a_second[begin+k]=2.0*c[2] + 6.0*c[3]*t;
+        }
+    }
+}
+
+const std::vector<double>& bspline_fit::breakpoints() const
+{
+    return m_breakpoints;
+}
+
+const std::vector<double>& bspline_fit::coefficients() const
+{
+    return m_coeffs;
+}
+
+void bspline_fit::export_piecewise(piecewise_cubic_t& curve) const
+{
+    curve=m_curve;
+}
+
+
+} // namespace tk
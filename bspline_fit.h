@@ -0,0 +1,76 @@
+/*
+ * bspline_fit.h
+ *
+ * cubic B-spline least squares fit, minimises
+ *   sum (y_i - f(x_i))^2
+ * over the coefficients of the B-spline basis on a given set of
+ * breakpoints, using the band_matrix solver from spline.h
+ *
+ */
+
+
+#ifndef TK_BSPLINE_FIT_H
+#define TK_BSPLINE_FIT_H
+
+#include "spline.h"
+#include "piecewise_cubic.h"
+
+#include <vector>
+
+
+namespace tk
+{
+
+// unlike tk::spline the curve does not pass through the points, the
+// breakpoints are chosen separately and can be much fewer than the points.
+// The normal equations (A^T*A)*c = A^T*y have 3 bands on each side and are
+// accumulated in one pass over the points, so the fit is O(points) and
+// the solve O(breakpoints). Evaluation uses the Horner form of every interval
+class bspline_fit : public interpolation_base_t
+{
+private:
+    std::vector<double> m_breakpoints;      // t_0 < ... < t_{m-1}
+    bool   m_breakpoints_set;               // else uniform over the data
+    size_t m_breakpoint_count;              // uniform count, 0 is automatic
+    std::vector<double> m_knots;            // clamped: t_0 x4, ..., t_{m-1} x4
+    std::vector<double> m_coeffs;           // m+2 B-spline coefficients
+    piecewise_cubic_t m_curve;              // Horner form with linear extrapolation
+    band_matrix m_system;                   // reused between fits
+
+    void make_breakpoints(const double* a_x, size_t a_size);
+    void to_piecewise();
+
+public:
+    bspline_fit();
+    virtual ~bspline_fit() override;
+
+    // optional before set_points(), at least 2 strictly increasing values
+    void set_breakpoints(const double* x, size_t count);
+    // optional before set_points(), count>=2 uniform breakpoints over the
+    // data range. Without either the count is size/4, from 2 to 1024
+    void set_breakpoint_count(size_t count);
+
+    // points outside of the breakpoints are ignored, a breakpoint interval
+    // without points gets its coefficient from a tiny second difference
+    // penalty, so the system stays regular
+    virtual void set_points(const double* a_x, const double* a_y, size_t a_size) override;
+    virtual double operator() (double x) override;
+    virtual void calc_array(const double* a_x, double* a_y, size_t a_count) override;
+    virtual interpolation_derivs_t calc_derivs(double x) override;
+    virtual void calc_derivs_array(const double* a_x, double* a_value,
+                                   double* a_first, double* a_second,
+                                   size_t a_count) override;
+
+    // reference evaluation with the de Boor algorithm straight from the
+    // coefficients, x is clamped to the breakpoints
+    double de_boor(double x) const;
+    const std::vector<double>& breakpoints() const;
+    const std::vector<double>& coefficients() const;
+    // coefficients in the interpolation independent form, see piecewise_cubic_t
+    void export_piecewise(piecewise_cubic_t& curve) const;
+};
+
+
+} // namespace tk
+
+#endif /* TK_BSPLINE_FIT_H */
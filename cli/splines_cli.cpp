@@ -0,0 +1,675 @@
+#include "curve_compression.h"
+#include "fit_pipeline.h"
+#include "input_normalization.h"
+#include "instrumentation.h"
+#include "interpolation_factory.h"
+#include "knot_subset.h"
+#include "parallel_for.h"
+#include "stream_evaluation.h"
+#include "table_fit.h"
+#include "table_reader.h"
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+
+const char* const usage_text =
+  "Usage: splines_cli --table FILE (--row N | --col N) [options]\n"
+  "       splines_cli --table FILE (--all-rows | --all-cols) [options]\n"
+  "       splines_cli --table FILE (--row N | --col N) --compress FILE\n"
+  "                   (--max-abs-error E | --max-rel-error PERCENT) [options]\n"
+  "\n"
+  "Fits one row or column of a table and evaluates the fit, or fits\n"
+  "every row or column and writes a report of the deviations.\n"
+  "The table layout is the one of the import dialog: the first row and\n"
+  "the first column hold X, series are counted from 1.\n"
+  "\n"
+  "  --table FILE        .csv with ';' separators or a binary table\n"
+  "                      (uint64 rows, uint64 cols, rows*cols doubles)\n"
+  "  --format csv|binary table format, by default from the extension\n"
+  "  --row N, --col N    series to fit\n"
+  "  --all-rows, --all-cols\n"
+  "                      fit every series, the output is a ';' separated\n"
+  "                      report and the summary goes to the stats\n"
+  "  --type NAME         cubic, hermite, linear, akima or makima (cubic),\n"
+  "                      a ',' separated list with --all-* (all types)\n"
+  "  --knots X1;X2;...   X of the points used as knots (all points)\n"
+  "  --grid MIN:MAX:STEP evaluate on a grid (default: data range, 400 steps)\n"
+  "  --query FILE        evaluate in X from a text file, one per line\n"
+  "  --query-binary FILE evaluate in X from a file of doubles,\n"
+  "                      the output is the file of Y doubles\n"
+  "  --compress FILE     write as few knots of --type as keep every\n"
+  "                      point within the error, see curve_compression.h\n"
+  "  --max-abs-error E   bound of |y - calculated| for --compress\n"
+  "  --max-rel-error P   bound of the relative deviation in percent\n"
+  "  --output FILE       result, '-' is stdout (default)\n"
+  "  --stats FILE        deviation statistics as JSON (default: stderr)\n"
+  "  --threads N         0 is all cores (default)\n";
+
+//One block of grid points, results and output text is in memory at once
+const std::size_t block_points = 1 << 20;
+const std::size_t min_points_per_thread = 4096;
+
+enum exit_code_t {
+  ec_ok = 0,
+  ec_usage = 1,
+  ec_error = 2
+};
+
+struct options_t
+{
+  std::string table_path;
+  bool format_set;
+  table_format_t format;
+  bool select_set;
+  table_select_t select;
+  bool all_series;
+  std::size_t index;
+  interpolation_type_t type;
+  std::size_t type_count;
+  std::array<bool, it_count> types;
+  bool knots_set;
+  std::vector<double> knots;
+  bool grid_set;
+  double grid_min;
+  double grid_max;
+  double grid_step;
+  std::string query_path;
+  bool query_binary;
+  std::string compress_path;
+  bool max_error_set;
+  compression_error_t error_kind;
+  double max_error;
+  std::string output_path;
+  std::string stats_path;
+  std::size_t threads;
+
+  options_t():
+    table_path(),
+    format_set(false),
+    format(table_format_t::csv),
+    select_set(false),
+    select(table_select_t::col),
+    all_series(false),
+    index(0),
+    type(it_cubic),
+    type_count(0),
+    types(),
+    knots_set(false),
+    knots(),
+    grid_set(false),
+    grid_min(0),
+    grid_max(0),
+    grid_step(0),
+    query_path(),
+    query_binary(false),
+    compress_path(),
+    max_error_set(false),
+    error_kind(compression_error_t::absolute),
+    max_error(0),
+    output_path("-"),
+    stats_path(),
+    threads(0)
+  {
+  }
+};
+
+bool parse_double(const char* ap_str, double& a_value)
+{
+  char* end = nullptr;
+  a_value = std::strtod(ap_str, &end);
+  return (end != ap_str) && (*end == '\0');
+}
+
+bool parse_size(const char* ap_str, std::size_t& a_value)
+{
+  char* end = nullptr;
+  unsigned long long value = std::strtoull(ap_str, &end, 10);
+  a_value = static_cast<std::size_t>(value);
+  return (end != ap_str) && (*end == '\0') && (ap_str[0] != '-');
+}
+
+bool parse_type(const char* ap_str, interpolation_type_t& a_type)
+{
+  for (size_t type = 0; type < it_count; type++) {
+    const char* name = interpolation_name(static_cast<interpolation_type_t>(type));
+    std::size_t length = std::strlen(name);
+    if (std::strlen(ap_str) != length) {
+      continue;
+    }
+    bool same = true;
+    for (std::size_t i = 0; i < length; i++) {
+      same = same && (std::tolower(static_cast<unsigned char>(ap_str[i])) ==
+        std::tolower(static_cast<unsigned char>(name[i])));
+    }
+    if (same) {
+      a_type = static_cast<interpolation_type_t>(type);
+      return true;
+    }
+  }
+  return false;
+}
+
+//',' separated names, the first one is also the type of a single series
+bool parse_types(const char* ap_str, options_t& a_options)
+{
+  std::string str = ap_str;
+  std::size_t begin = 0;
+  while (begin <= str.size()) {
+    std::size_t end = std::min(str.find(',', begin), str.size());
+    interpolation_type_t type = it_cubic;
+    if (!parse_type(str.substr(begin, end - begin).c_str(), type)) {
+      return false;
+    }
+    if (a_options.type_count == 0) {
+      a_options.type = type;
+    }
+    if (!a_options.types[type]) {
+      a_options.types[type] = true;
+      a_options.type_count++;
+    }
+    begin = end + 1;
+  }
+  return true;
+}
+
+//Values separated by a_separator, empty values are skipped
+bool parse_list(const char* ap_str, char a_separator, std::vector<double>& a_values)
+{
+  a_values.clear();
+  std::string str = ap_str;
+  std::size_t begin = 0;
+  while (begin <= str.size()) {
+    std::size_t end = std::min(str.find(a_separator, begin), str.size());
+    std::string item = str.substr(begin, end - begin);
+    //',' is accepted as the decimal separator, as in the tables
+    std::replace(item.begin(), item.end(), ',', '.');
+    if (!item.empty()) {
+      double value = 0;
+      if (!parse_double(item.c_str(), value)) {
+        return false;
+      }
+      a_values.push_back(value);
+    }
+    begin = end + 1;
+  }
+  return true;
+}
+
+bool parse_options(int argc, char* argv[], options_t& a_options, std::string& a_error)
+{
+  for (int i = 1; i < argc; i++) {
+    std::string name = argv[i];
+    if ((name == "--help") || (name == "-h")) {
+      a_error.clear();
+      return false;
+    }
+    if ((name == "--all-rows") || (name == "--all-cols")) {
+      a_options.select_set = true;
+      a_options.all_series = true;
+      a_options.select = (name == "--all-rows") ? table_select_t::row : table_select_t::col;
+      continue;
+    }
+    if (i + 1 >= argc) {
+      a_error = name + " needs a value";
+      return false;
+    }
+    const char* value = argv[++i];
+    bool ok = true;
+    if (name == "--table") {
+      a_options.table_path = value;
+    } else if (name == "--format") {
+      a_options.format_set = true;
+      if (std::strcmp(value, "csv") == 0) {
+        a_options.format = table_format_t::csv;
+      } else if (std::strcmp(value, "binary") == 0) {
+        a_options.format = table_format_t::binary;
+      } else {
+        ok = false;
+      }
+    } else if ((name == "--row") || (name == "--col")) {
+      a_options.select_set = true;
+      a_options.select = (name == "--row") ? table_select_t::row : table_select_t::col;
+      ok = parse_size(value, a_options.index);
+    } else if (name == "--type") {
+      ok = parse_types(value, a_options);
+    } else if (name == "--knots") {
+      a_options.knots_set = true;
+      ok = parse_list(value, ';', a_options.knots);
+    } else if (name == "--grid") {
+      std::vector<double> grid;
+      ok = parse_list(value, ':', grid) && (grid.size() == 3) &&
+        (grid[2] > 0) && (grid[0] <= grid[1]);
+      if (ok) {
+        a_options.grid_set = true;
+        a_options.grid_min = grid[0];
+        a_options.grid_max = grid[1];
+        a_options.grid_step = grid[2];
+      }
+    } else if ((name == "--query") || (name == "--query-binary")) {
+      a_options.query_path = value;
+      a_options.query_binary = (name == "--query-binary");
+    } else if (name == "--compress") {
+      a_options.compress_path = value;
+    } else if ((name == "--max-abs-error") || (name == "--max-rel-error")) {
+      a_options.max_error_set = true;
+      a_options.error_kind = (name == "--max-abs-error") ?
+        compression_error_t::absolute : compression_error_t::relative;
+      ok = parse_double(value, a_options.max_error) && (a_options.max_error >= 0);
+    } else if (name == "--output") {
+      a_options.output_path = value;
+    } else if (name == "--stats") {
+      a_options.stats_path = value;
+    } else if (name == "--threads") {
+      ok = parse_size(value, a_options.threads);
+    } else {
+      a_error = "unknown option " + name;
+      return false;
+    }
+    if (!ok) {
+      a_error = "invalid value of " + name + ": " + value;
+      return false;
+    }
+  }
+  if (a_options.table_path.empty() || !a_options.select_set) {
+    a_error = "--table and --row, --col, --all-rows or --all-cols are required";
+    return false;
+  }
+  if (a_options.all_series) {
+    if (a_options.grid_set || !a_options.query_path.empty()) {
+      a_error = "--grid and --query evaluate one series, not --all-rows or --all-cols";
+      return false;
+    }
+    if (a_options.type_count == 0) {
+      a_options.types.fill(true);
+    }
+  } else if (a_options.type_count > 1) {
+    a_error = "one --type is fitted with --row or --col";
+    return false;
+  }
+  if (!a_options.compress_path.empty()) {
+    if (a_options.all_series || a_options.knots_set || a_options.grid_set ||
+      !a_options.query_path.empty()) {
+      a_error = "--compress chooses the knots of one series, it can't be used with "
+        "--all-*, --knots, --grid or --query";
+      return false;
+    }
+    if (!a_options.max_error_set) {
+      a_error = "--compress needs --max-abs-error or --max-rel-error";
+      return false;
+    }
+  }
+  if (a_options.grid_set && !a_options.query_path.empty()) {
+    a_error = "--grid and --query can't be used together";
+    return false;
+  }
+  return true;
+}
+
+//Interpolations are not shared between threads, every thread
+//evaluates its own fitted copy
+class block_evaluator_t
+{
+public:
+  block_evaluator_t(const std::vector<std::unique_ptr<interpolation_base_t>>& a_interpolations,
+    std::FILE* ap_output):
+    m_interpolations(a_interpolations),
+    mp_output(ap_output),
+    m_y(),
+    m_text(a_interpolations.size()),
+    m_count(0)
+  {
+  }
+
+  //Evaluates, formats and writes one block, false on a write error
+  bool evaluate(const std::vector<double>& a_x)
+  {
+    m_y.resize(a_x.size());
+    std::size_t thread_count = parallel_thread_count(a_x.size(), min_points_per_thread,
+      m_interpolations.size());
+    for_each_chunk(a_x.size(), thread_count,
+      [&](std::size_t a_thread, std::size_t a_begin, std::size_t a_end) {
+        m_interpolations[a_thread]->calc_array(a_x.data() + a_begin, m_y.data() + a_begin,
+          a_end - a_begin);
+        m_text[a_thread].clear();
+        format_xy_text(a_x.data() + a_begin, m_y.data() + a_begin, a_end - a_begin,
+          m_text[a_thread]);
+      });
+    m_count += a_x.size();
+
+    for (std::size_t thread = 0; thread < thread_count; thread++) {
+      const std::string& text = m_text[thread];
+      if (std::fwrite(text.data(), 1, text.size(), mp_output) != text.size()) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  std::size_t count() const
+  {
+    return m_count;
+  }
+
+private:
+  const std::vector<std::unique_ptr<interpolation_base_t>>& m_interpolations;
+  std::FILE* mp_output;
+  std::vector<double> m_y;
+  //Output of every thread, written in the thread order
+  std::vector<std::string> m_text;
+  std::size_t m_count;
+};
+
+bool evaluate_grid(double a_min, double a_max, double a_step, block_evaluator_t& a_evaluator,
+  std::string& a_error)
+{
+  //Same samples as the chart: from min while less than max
+  const std::size_t count = static_cast<std::size_t>(std::ceil((a_max - a_min) / a_step));
+  std::vector<double> x;
+  for (std::size_t begin = 0; begin < count; begin += block_points) {
+    std::size_t end = std::min(count, begin + block_points);
+    x.resize(end - begin);
+    for (std::size_t i = begin; i < end; i++) {
+      x[i - begin] = a_min + static_cast<double>(i) * a_step;
+    }
+    if (!a_evaluator.evaluate(x)) {
+      a_error = "write error";
+      return false;
+    }
+  }
+  return true;
+}
+
+deviation_stats_t calc_deviation_stats(
+  const std::vector<std::unique_ptr<interpolation_base_t>>& a_interpolations,
+  const std::vector<double>& a_x, const std::vector<double>& a_y)
+{
+  std::size_t thread_count = parallel_thread_count(a_x.size(), min_points_per_thread,
+    a_interpolations.size());
+  std::vector<deviation_stats_t> thread_stats(thread_count);
+  for_each_chunk(a_x.size(), thread_count,
+    [&](std::size_t a_thread, std::size_t a_begin, std::size_t a_end) {
+      std::vector<double> calculated(a_end - a_begin);
+      a_interpolations[a_thread]->calc_array(a_x.data() + a_begin, calculated.data(),
+        calculated.size());
+      for (std::size_t i = a_begin; i < a_end; i++) {
+        thread_stats[a_thread].add(a_x[i], relative_deviation(a_y[i], calculated[i - a_begin]));
+      }
+    });
+
+  deviation_stats_t stats;
+  for (const deviation_stats_t& part: thread_stats) {
+    stats.merge(part);
+  }
+  return stats;
+}
+
+std::string json_number(double a_value)
+{
+  if (!std::isfinite(a_value)) {
+    return "null";
+  }
+  char number[32];
+  std::snprintf(number, sizeof(number), "%.17g", a_value);
+  return number;
+}
+
+std::string json_string(const std::string& a_value)
+{
+  std::string json = "\"";
+  for (char c: a_value) {
+    if ((c == '"') || (c == '\\')) {
+      json += '\\';
+    }
+    json += c;
+  }
+  return json + "\"";
+}
+
+std::string stats_to_json(const options_t& a_options, std::size_t a_points, std::size_t a_knots,
+  const deviation_stats_t& a_stats, std::uint64_t a_evaluated, std::uint64_t a_skipped)
+{
+  std::string json = "{\"table\":" + json_string(a_options.table_path);
+  json += std::string(",\"") + (a_options.select == table_select_t::row ? "row" : "col") +
+    "\":" + std::to_string(a_options.index);
+  json += std::string(",\"type\":\"") + interpolation_name(a_options.type) + "\"";
+  json += ",\"points\":" + std::to_string(a_points);
+  json += ",\"knots\":" + std::to_string(a_knots);
+  //Deviations are relative, in percent, like in the main window
+  json += ",\"max_abs_deviation\":" + json_number(a_stats.max_abs);
+  json += ",\"max_abs_deviation_x\":" + json_number(a_stats.max_abs_x);
+  json += ",\"mean_abs_deviation\":" + json_number(a_stats.mean_abs());
+  json += ",\"rms_deviation\":" + json_number(a_stats.rms());
+  //Points where the fit is 0, they are not in the deviations above
+  json += ",\"non_finite_deviations\":" + std::to_string(a_stats.non_finite);
+  json += ",\"evaluated\":" + std::to_string(a_evaluated);
+  json += ",\"skipped_queries\":" + std::to_string(a_skipped);
+  if (instr_enabled()) {
+    json += ",\"instrumentation\":" + instr_to_json(instr_snapshot());
+  }
+  json += "}\n";
+  return json;
+}
+
+bool write_text(const std::string& a_path, const std::string& a_text, std::FILE* ap_default)
+{
+  std::FILE* file = a_path.empty() || (a_path == "-") ? ap_default :
+    std::fopen(a_path.c_str(), "wb");
+  bool written = file &&
+    (std::fwrite(a_text.data(), 1, a_text.size(), file) == a_text.size());
+  if (file && (((file != ap_default) ? std::fclose(file) : std::fflush(file)) != 0)) {
+    written = false;
+  }
+  return written;
+}
+
+int compress_series(const options_t& a_options, const std::vector<double>& a_x,
+  const std::vector<double>& a_y)
+{
+  compression_options_t compression;
+  compression.type = a_options.type;
+  compression.error = a_options.error_kind;
+  compression.max_error = a_options.max_error;
+  compressed_curve_t curve;
+  compression_stats_t stats;
+  std::string error;
+  auto start = std::chrono::steady_clock::now();
+  if (!compress_curve(a_x, a_y, compression, curve, stats, error)) {
+    std::fprintf(stderr, "splines_cli: %s\n", error.c_str());
+    return ec_error;
+  }
+  const double fit_ms = std::chrono::duration<double, std::milli>(
+    std::chrono::steady_clock::now() - start).count();
+
+  const std::string data = serialize_curve(curve);
+  if (!write_text(a_options.compress_path, data, stdout)) {
+    std::fprintf(stderr, "splines_cli: can't write %s\n", a_options.compress_path.c_str());
+    return ec_error;
+  }
+
+  const std::size_t input_bytes = 2 * sizeof(double) * a_x.size();
+  std::string json = "{\"table\":" + json_string(a_options.table_path);
+  json += std::string(",\"") + (a_options.select == table_select_t::row ? "row" : "col") +
+    "\":" + std::to_string(a_options.index);
+  json += std::string(",\"type\":\"") + interpolation_name(a_options.type) + "\"";
+  json += std::string(",\"error\":\"") +
+    (a_options.error_kind == compression_error_t::absolute ? "absolute" : "relative") + "\"";
+  json += ",\"max_error_bound\":" + json_number(a_options.max_error);
+  json += ",\"max_error\":" + json_number(stats.max_error);
+  json += ",\"points\":" + std::to_string(stats.points);
+  json += ",\"knots\":" + std::to_string(stats.knots);
+  json += ",\"rounds\":" + std::to_string(stats.rounds);
+  json += ",\"input_bytes\":" + std::to_string(input_bytes);
+  json += ",\"compressed_bytes\":" + std::to_string(data.size());
+  json += ",\"compression_ratio\":" +
+    json_number(static_cast<double>(input_bytes) / static_cast<double>(data.size()));
+  json += ",\"fit_ms\":" + json_number(fit_ms);
+  json += "}\n";
+  if (!write_text(a_options.stats_path, json, stderr)) {
+    std::fprintf(stderr, "splines_cli: can't write %s\n", a_options.stats_path.c_str());
+    return ec_error;
+  }
+  return ec_ok;
+}
+
+int fit_all_series(const options_t& a_options)
+{
+  table_t table;
+  std::string error;
+  if (!read_table(a_options.table_path, a_options.format, table, error)) {
+    std::fprintf(stderr, "splines_cli: %s\n", error.c_str());
+    return ec_error;
+  }
+  table_fit_options_t fit_options;
+  fit_options.select = a_options.select;
+  fit_options.knots = a_options.knots;
+  fit_options.enable = a_options.types;
+  fit_options.threads = a_options.threads;
+  std::vector<series_fit_t> results = fit_table(table, fit_options);
+
+  if (!write_text(a_options.output_path, table_fit_report(results, a_options.select), stdout)) {
+    std::fprintf(stderr, "splines_cli: can't write %s\n", a_options.output_path.c_str());
+    return ec_error;
+  }
+  if (!write_text(a_options.stats_path, table_fit_summary(results, a_options.select), stderr)) {
+    std::fprintf(stderr, "splines_cli: can't write %s\n", a_options.stats_path.c_str());
+    return ec_error;
+  }
+  return ec_ok;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+  options_t options;
+  std::string error;
+  if (!parse_options(argc, argv, options, error)) {
+    if (!error.empty()) {
+      std::fprintf(stderr, "splines_cli: %s\n\n", error.c_str());
+    }
+    std::fputs(usage_text, error.empty() ? stdout : stderr);
+    return error.empty() ? ec_ok : ec_usage;
+  }
+  if (!options.format_set) {
+    options.format = table_format_from_path(options.table_path);
+  }
+  if (options.all_series) {
+    return fit_all_series(options);
+  }
+
+  std::vector<double> x;
+  std::vector<double> y;
+  if (!read_table_series(options.table_path, options.format, options.select, options.index,
+    x, y, error)) {
+    std::fprintf(stderr, "splines_cli: %s\n", error.c_str());
+    return ec_error;
+  }
+  normalize_points(x, y, duplicate_policy_t::mean);
+  if (x.size() < 2) {
+    std::fprintf(stderr, "splines_cli: not enough points to calculate spline\n");
+    return ec_error;
+  }
+  if (!options.compress_path.empty()) {
+    return compress_series(options, x, y);
+  }
+
+  knot_subset_t knots;
+  if (options.knots_set) {
+    if (!knots.assign(x, options.knots)) {
+      std::fprintf(stderr, "splines_cli: some knots are not X of the series\n");
+      return ec_error;
+    }
+  } else {
+    knots.assign(x, x);
+  }
+  if (knots.size() < 2) {
+    std::fprintf(stderr, "splines_cli: at least two knots are needed\n");
+    return ec_error;
+  }
+  std::vector<double> knot_x;
+  std::vector<double> knot_y;
+  knots.gather(x, knot_x);
+  knots.gather(y, knot_y);
+
+  const std::size_t thread_count = parallel_thread_count(std::size_t(-1), 1, options.threads);
+  std::vector<std::unique_ptr<interpolation_base_t>> interpolations(thread_count);
+  for_each_chunk(thread_count, thread_count,
+    [&](std::size_t a_thread, std::size_t, std::size_t) {
+      interpolations[a_thread] = make_interpolation(options.type);
+      interpolations[a_thread]->set_points(knot_x.data(), knot_y.data(), knot_x.size());
+    });
+
+  deviation_stats_t stats = calc_deviation_stats(interpolations, x, y);
+
+  std::FILE* output = stdout;
+  if (options.output_path != "-") {
+    output = std::fopen(options.output_path.c_str(), "wb");
+    if (!output) {
+      std::fprintf(stderr, "splines_cli: can't open %s\n", options.output_path.c_str());
+      return ec_error;
+    }
+  }
+
+  block_evaluator_t evaluator(interpolations, output);
+  stream_stats_t stream_stats;
+  bool ok = true;
+  if (!options.query_path.empty()) {
+    std::FILE* input = std::fopen(options.query_path.c_str(), "rb");
+    if (input) {
+      stream_options_t stream_options;
+      stream_options.input_format = options.query_binary ?
+        stream_format_t::binary : stream_format_t::text;
+      stream_options.output_format = stream_options.input_format;
+      ok = evaluate_stream(input, output, interpolations, stream_options, stream_stats, error);
+      std::fclose(input);
+    } else {
+      ok = false;
+      error = "can't open " + options.query_path;
+    }
+  } else {
+    if (!options.grid_set) {
+      options.grid_min = x.front();
+      options.grid_max = x.back();
+      options.grid_step = (x.back() - x.front()) / 400;
+    }
+    ok = evaluate_grid(options.grid_min, options.grid_max, options.grid_step, evaluator, error);
+  }
+  if (((output != stdout) ? std::fclose(output) : std::fflush(output)) != 0) {
+    ok = false;
+    error = "write error";
+  }
+  if (!ok) {
+    std::fprintf(stderr, "splines_cli: %s\n", error.c_str());
+    return ec_error;
+  }
+
+  std::string json = stats_to_json(options, x.size(), knots.size(), stats,
+    evaluator.count() + stream_stats.evaluated, stream_stats.skipped);
+  if (options.stats_path.empty()) {
+    std::fputs(json.c_str(), stderr);
+  } else {
+    std::FILE* stats_file = std::fopen(options.stats_path.c_str(), "w");
+    bool written = stats_file && (std::fputs(json.c_str(), stats_file) >= 0);
+    if (stats_file && (std::fclose(stats_file) != 0)) {
+      written = false;
+    }
+    if (!written) {
+      std::fprintf(stderr, "splines_cli: can't write %s\n", options.stats_path.c_str());
+      return ec_error;
+    }
+  }
+  return ec_ok;
+}
@@ -0,0 +1,55 @@
+#-------------------------------------------------
+#
+# Headless fitting and evaluation of table series,
+# builds without Qt modules and without a display
+#
+#-------------------------------------------------
+
+TARGET = splines_cli
+TEMPLATE = app
+
+CONFIG += console c++17
+CONFIG -= qt app_bundle
+
+# See instrumentation.h, the statistics then include the counters
+#DEFINES += SPLINES_INSTRUMENTATION
+
+INCLUDEPATH += ..
+
+SOURCES += \
+        splines_cli.cpp \
+        ../curve_compression.cpp \
+        ../fit_pipeline.cpp \
+        ../hermit.cpp \
+        ../input_normalization.cpp \
+        ../instrumentation.cpp \
+        ../interpolation_factory.cpp \
+        ../knot_subset.cpp \
+        ../spline.cpp \
+        ../stream_evaluation.cpp \
+        ../table_fit.cpp \
+        ../table_reader.cpp
+
+HEADERS += \
+        ../akima.h \
+        ../cubic_eval.h \
+        ../curve_compression.h \
+        ../fit_pipeline.h \
+        ../hermit.h \
+        ../input_normalization.h \
+        ../instrumentation.h \
+        ../interpolation_base.h \
+        ../interpolation_factory.h \
+        ../knot_subset.h \
+        ../linear_interpolation.hpp \
+        ../parallel_for.h \
+        ../segment_search.h \
+        ../spline.h \
+        ../stream_evaluation.h \
+        ../table_fit.h \
+        ../table_reader.h
+
+unix: LIBS += -pthread
+
+unix:!android: target.path = /opt/$${TARGET}/bin
+!isEmpty(target.path): INSTALLS += target
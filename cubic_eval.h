@@ -0,0 +1,45 @@
+#ifndef CUBIC_EVAL_H
+#define CUBIC_EVAL_H
+
+#include "segment_search.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+//Value and the first two derivatives of piecewise cubic
+//  f(x) = y[i] + h*(c1[i] + h*(c2[i] + h*c3[i])), h = x - knots[i]
+//for a batch of points. Segments are found first for a whole chunk,
+//then the polynomials are evaluated in a separate branch-free loop
+//over gathered coefficients, which the compiler can vectorize
+template <class T, class A>
+void calc_cubic_derivs_array(const std::vector<T, A>& a_knots, const T* a_y,
+  const T* a_c1, const T* a_c2, const T* a_c3,
+  const T* a_x, T* a_value, T* a_first, T* a_second, std::size_t a_count)
+{
+  const std::size_t chunk_size = 256;
+  std::size_t segments[chunk_size];
+  T h[chunk_size];
+
+  std::size_t segment = 0;
+  for (std::size_t begin = 0; begin < a_count; begin += chunk_size) {
+    const std::size_t count = std::min(chunk_size, a_count - begin);
+    for (std::size_t k = 0; k < count; k++) {
+      segment = find_segment(a_knots, a_x[begin + k], segment);
+      segments[k] = segment;
+      h[k] = a_x[begin + k] - a_knots[segment];
+    }
+    for (std::size_t k = 0; k < count; k++) {
+      const std::size_t i = segments[k];
+      const T c1 = a_c1[i];
+      const T c2 = a_c2[i];
+      const T c3 = a_c3[i];
+      const T t = h[k];
+      a_value[begin + k] = a_y[i] + t * (c1 + t * (c2 + t * c3));
+      a_first[begin + k] = c1 + t * (2 * c2 + t * 3 * c3);
+      a_second[begin + k] = 2 * c2 + 6 * c3 * t;
+    }
+  }
+}
+
+#endif // CUBIC_EVAL_H
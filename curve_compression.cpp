@@ -0,0 +1,203 @@
+#include "curve_compression.h"
+#include "fit_pipeline.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iterator>
+#include <limits>
+
+namespace {
+
+const char curve_magic[4] = { 'S', 'P', 'L', 'C' };
+const std::uint8_t curve_format_version = 1;
+//Magic, version, type, two reserved bytes, knot count
+const std::size_t curve_header_size = 12;
+
+//Error of one point in the units of the options, infinity for NaN
+double point_error(double a_y, double a_calculated, const compression_options_t& a_options)
+{
+  double error = (a_options.error == compression_error_t::absolute) ?
+    std::abs(a_y - a_calculated) : std::abs(relative_deviation(a_y, a_calculated));
+  return std::isnan(error) ? std::numeric_limits<double>::infinity() : error;
+}
+
+//Largest |y - calculated| that keeps the point within the bound.
+//For the relative error |calculated| >= |y| / (1 + r) inside the band,
+//so r * |y| / (1 + r) is never more than r * |calculated|
+double point_tolerance(double a_y, const compression_options_t& a_options)
+{
+  if (a_options.error == compression_error_t::absolute) {
+    return a_options.max_error;
+  }
+  const double ratio = a_options.max_error / 100;
+  return ratio * std::abs(a_y) / (1 + ratio);
+}
+
+//One pass: the segment from the last knot goes on while its slope stays in
+//the cone of slopes that pass through the tolerance band of every skipped point
+void stream_linear_knots(const std::vector<double>& a_x, const std::vector<double>& a_y,
+  const compression_options_t& a_options, std::vector<std::size_t>& a_knots)
+{
+  const double infinity = std::numeric_limits<double>::infinity();
+  a_knots.assign(1, 0);
+  std::size_t anchor = 0;
+  double low = -infinity;
+  double high = infinity;
+  for (std::size_t i = 1; i < a_x.size(); i++) {
+    double dx = a_x[i] - a_x[anchor];
+    const double slope = (a_y[i] - a_y[anchor]) / dx;
+    if ((slope < low) || (slope > high)) {
+      //Point i can't end the segment, the previous point becomes a knot
+      anchor = i - 1;
+      a_knots.push_back(anchor);
+      low = -infinity;
+      high = infinity;
+      dx = a_x[i] - a_x[anchor];
+    }
+    const double tolerance = point_tolerance(a_y[i], a_options);
+    low = std::max(low, (a_y[i] - tolerance - a_y[anchor]) / dx);
+    high = std::min(high, (a_y[i] + tolerance - a_y[anchor]) / dx);
+  }
+  if (a_knots.back() != a_x.size() - 1) {
+    a_knots.push_back(a_x.size() - 1);
+  }
+}
+
+} // namespace
+
+std::unique_ptr<interpolation_base_t> compressed_curve_t::make_interpolation() const
+{
+  std::unique_ptr<interpolation_base_t> interpolation = ::make_interpolation(type);
+  interpolation->set_points(x.data(), y.data(), x.size());
+  return interpolation;
+}
+
+bool compress_curve(const std::vector<double>& a_x, const std::vector<double>& a_y,
+  const compression_options_t& a_options, compressed_curve_t& a_curve,
+  compression_stats_t& a_stats, std::string& a_error)
+{
+  if ((a_x.size() != a_y.size()) || (a_x.size() < 2)) {
+    a_error = "at least two points are needed";
+    return false;
+  }
+  if (!(a_options.max_error >= 0) || (a_options.type >= it_count)) {
+    a_error = "invalid compression options";
+    return false;
+  }
+  const std::size_t count = a_x.size();
+  a_stats = compression_stats_t();
+  a_stats.points = count;
+
+  std::vector<std::size_t> knots;
+  if (a_options.type == it_linear) {
+    stream_linear_knots(a_x, a_y, a_options, knots);
+  } else {
+    knots.push_back(0);
+    knots.push_back(count - 1);
+  }
+
+  //Refit until every interval between knots is within the bound. The linear
+  //knots normally pass the first check, it only catches rounding of the cone.
+  //Knots are points of the series and the interpolations pass through them,
+  //so in the worst case every point becomes a knot and the error is 0
+  std::unique_ptr<interpolation_base_t> interpolation = make_interpolation(a_options.type);
+  std::vector<double> calculated(count);
+  std::vector<std::size_t> added;
+  std::vector<std::size_t> merged;
+  for (;;) {
+    a_curve.x.resize(knots.size());
+    a_curve.y.resize(knots.size());
+    for (std::size_t i = 0; i < knots.size(); i++) {
+      a_curve.x[i] = a_x[knots[i]];
+      a_curve.y[i] = a_y[knots[i]];
+    }
+    interpolation->set_points(a_curve.x.data(), a_curve.y.data(), knots.size());
+    interpolation->calc_array(a_x.data(), calculated.data(), count);
+    a_stats.rounds++;
+
+    added.clear();
+    a_stats.max_error = 0;
+    std::size_t next_knot = 0;
+    std::size_t worst = count;
+    double worst_error = 0;
+    for (std::size_t i = 0; i < count; i++) {
+      if (i == knots[next_knot]) {
+        if (worst != count) {
+          added.push_back(worst);
+          worst = count;
+        }
+        next_knot++;
+        continue;
+      }
+      const double error = point_error(a_y[i], calculated[i], a_options);
+      a_stats.max_error = std::max(a_stats.max_error, error);
+      if ((error > a_options.max_error) && ((worst == count) || (error > worst_error))) {
+        worst = i;
+        worst_error = error;
+      }
+    }
+    if (added.empty()) {
+      break;
+    }
+    merged.clear();
+    std::merge(knots.begin(), knots.end(), added.begin(), added.end(),
+      std::back_inserter(merged));
+    knots.swap(merged);
+  }
+
+  a_curve.type = a_options.type;
+  a_stats.knots = knots.size();
+  return true;
+}
+
+std::string serialize_curve(const compressed_curve_t& a_curve)
+{
+  const std::uint32_t knot_count = static_cast<std::uint32_t>(a_curve.x.size());
+  std::string data(curve_header_size + 2 * sizeof(double) * knot_count, '\0');
+  char* dst = &data[0];
+  std::memcpy(dst, curve_magic, sizeof(curve_magic));
+  dst[4] = static_cast<char>(curve_format_version);
+  dst[5] = static_cast<char>(a_curve.type);
+  std::memcpy(dst + 8, &knot_count, sizeof(knot_count));
+  dst += curve_header_size;
+  std::memcpy(dst, a_curve.x.data(), sizeof(double) * knot_count);
+  std::memcpy(dst + sizeof(double) * knot_count, a_curve.y.data(), sizeof(double) * knot_count);
+  return data;
+}
+
+bool deserialize_curve(const std::string& a_data, compressed_curve_t& a_curve,
+  std::string& a_error)
+{
+  if ((a_data.size() < curve_header_size) ||
+    (std::memcmp(a_data.data(), curve_magic, sizeof(curve_magic)) != 0)) {
+    a_error = "not a compressed curve";
+    return false;
+  }
+  const char* src = a_data.data();
+  if (static_cast<std::uint8_t>(src[4]) != curve_format_version) {
+    a_error = "unsupported compressed curve version";
+    return false;
+  }
+  const std::uint8_t type = static_cast<std::uint8_t>(src[5]);
+  std::uint32_t knot_count = 0;
+  std::memcpy(&knot_count, src + 8, sizeof(knot_count));
+  if ((type >= it_count) || (knot_count < 2) ||
+    (a_data.size() != curve_header_size + 2 * sizeof(double) * knot_count)) {
+    a_error = "corrupted compressed curve";
+    return false;
+  }
+  src += curve_header_size;
+  a_curve.type = static_cast<interpolation_type_t>(type);
+  a_curve.x.resize(knot_count);
+  a_curve.y.resize(knot_count);
+  std::memcpy(a_curve.x.data(), src, sizeof(double) * knot_count);
+  std::memcpy(a_curve.y.data(), src + sizeof(double) * knot_count, sizeof(double) * knot_count);
+  for (std::size_t i = 1; i < a_curve.x.size(); i++) {
+    if (!(a_curve.x[i] > a_curve.x[i - 1])) {
+      a_error = "corrupted compressed curve";
+      return false;
+    }
+  }
+  return true;
+}
@@ -0,0 +1,88 @@
+#ifndef CURVE_COMPRESSION_H
+#define CURVE_COMPRESSION_H
+
+#include "interpolation_factory.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+//Turns a dense series into a few knots of an interpolation that reproduces
+//every point within the error bound. Knots are points of the series, so the
+//curve is rebuilt by set_points on the knots alone
+
+enum class compression_error_t {
+  //|y - calculated| <= max_error
+  absolute,
+  //|relative_deviation(y, calculated)| <= max_error, in percent
+  relative
+};
+
+struct compression_options_t
+{
+  interpolation_type_t type;
+  compression_error_t error;
+  double max_error;
+
+  compression_options_t():
+    type(it_cubic),
+    error(compression_error_t::absolute),
+    max_error(0)
+  {
+  }
+};
+
+struct compressed_curve_t
+{
+  interpolation_type_t type;
+  std::vector<double> x;
+  std::vector<double> y;
+
+  compressed_curve_t():
+    type(it_cubic),
+    x(),
+    y()
+  {
+  }
+
+  //Fitted interpolation of the knots
+  std::unique_ptr<interpolation_base_t> make_interpolation() const;
+};
+
+struct compression_stats_t
+{
+  std::size_t points;
+  std::size_t knots;
+  //Fits over the whole input, linear normally needs one
+  std::size_t rounds;
+  //Largest error over the input, in the units of the options
+  double max_error;
+
+  compression_stats_t():
+    points(0),
+    knots(0),
+    rounds(0),
+    max_error(0)
+  {
+  }
+};
+
+//a_x must be strictly increasing, see normalize_points.
+//Linear is one streaming pass that keeps the cone of slopes that still fit
+//every skipped point. The other types start from the ends and refit in
+//rounds, every round adds the worst point of each interval that breaks the
+//bound. Returns false and a_error if the input or the options are invalid
+bool compress_curve(const std::vector<double>& a_x, const std::vector<double>& a_y,
+  const compression_options_t& a_options, compressed_curve_t& a_curve,
+  compression_stats_t& a_stats, std::string& a_error);
+
+//"SPLC", format version byte, interpolation type byte, two reserved bytes,
+//uint32 knot count, then knot x and knot y as doubles, all in the native
+//byte order: 16 bytes per knot
+std::string serialize_curve(const compressed_curve_t& a_curve);
+bool deserialize_curve(const std::string& a_data, compressed_curve_t& a_curve,
+  std::string& a_error);
+
+#endif // CURVE_COMPRESSION_H
@@ -0,0 +1,321 @@
+#include "curve_registry.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <limits>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2,
+  "shared memory counters must be lock-free to be used across processes");
+
+struct curve_registry_slot_t
+{
+  //Odd while the writer changes the slot
+  std::atomic<std::uint64_t> sequence;
+  std::uint64_t version;
+  std::uint64_t knot_count;
+  double period;
+};
+
+struct curve_registry_header_t
+{
+  //Written last, readers ignore the object until it is set
+  std::atomic<std::uint32_t> magic;
+  std::uint32_t layout_version;
+  std::uint64_t capacity;
+  //Number of publishes, the current slot is generation % 2
+  std::atomic<std::uint64_t> generation;
+  curve_registry_slot_t slots[2];
+};
+
+namespace {
+
+constexpr std::uint32_t registry_magic = 0x53504c43;
+constexpr std::uint32_t registry_layout_version = 1;
+
+//A '/' would make the name invalid for shm_open, a '\0' would cut it
+bool is_valid_name(const std::string& a_name)
+{
+  return !a_name.empty() && (a_name.find('/') == std::string::npos) &&
+    (a_name.find('\0') == std::string::npos);
+}
+
+std::string object_name(const std::string& a_name)
+{
+  return "/splines_curve_" + a_name;
+}
+
+std::size_t slot_doubles(std::size_t a_capacity)
+{
+  return a_capacity + (a_capacity + 1) * piecewise_cubic_t::coeffs_per_segment;
+}
+
+std::size_t mapped_size(std::size_t a_capacity)
+{
+  return sizeof(curve_registry_header_t) + 2 * slot_doubles(a_capacity) * sizeof(double);
+}
+
+const double* slot_data(const curve_registry_header_t* ap_header, std::size_t a_slot)
+{
+  const double* data = reinterpret_cast<const double*>(ap_header + 1);
+  return data + a_slot * slot_doubles(static_cast<std::size_t>(ap_header->capacity));
+}
+
+double* slot_data(curve_registry_header_t* ap_header, std::size_t a_slot)
+{
+  double* data = reinterpret_cast<double*>(ap_header + 1);
+  return data + a_slot * slot_doubles(static_cast<std::size_t>(ap_header->capacity));
+}
+
+//Runs a_evaluate(slot, knots, coeffs, knot_count) on the current slot
+//until it was not changed during the evaluation
+template <class F>
+bool read_consistent(const curve_registry_header_t* ap_header, F a_evaluate)
+{
+  for (;;) {
+    const std::uint64_t generation = ap_header->generation.load(std::memory_order_acquire);
+    if (generation == 0) {
+      return false;
+    }
+    const std::size_t slot = generation % 2;
+    const curve_registry_slot_t& slot_header = ap_header->slots[slot];
+    const std::uint64_t sequence = slot_header.sequence.load(std::memory_order_acquire);
+    if (sequence % 2 != 0) {
+      continue;
+    }
+    //A torn count must not lead outside of the mapping
+    std::size_t knot_count = static_cast<std::size_t>(
+      std::min(slot_header.knot_count, ap_header->capacity));
+    if (knot_count >= 2) {
+      const double* knots = slot_data(ap_header, slot);
+      a_evaluate(slot_header, knots, knots + ap_header->capacity, knot_count);
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if ((slot_header.sequence.load(std::memory_order_relaxed) == sequence) &&
+        (knot_count >= 2)) {
+      return true;
+    }
+  }
+}
+
+} // namespace
+
+curve_writer_t::curve_writer_t():
+  mp_header(nullptr),
+  m_mapped_size(0)
+{
+}
+
+curve_writer_t::~curve_writer_t()
+{
+  close();
+}
+
+bool curve_writer_t::open(const std::string& a_name, std::size_t a_capacity, unsigned a_mode)
+{
+  close();
+  if ((a_capacity < 2) || !is_valid_name(a_name)) {
+    return false;
+  }
+  const mode_t mode = static_cast<mode_t>(a_mode) & ~static_cast<mode_t>(S_IWGRP | S_IWOTH);
+  int fd = shm_open(object_name(a_name).c_str(), O_RDWR | O_CREAT, mode);
+  if (fd < 0) {
+    return false;
+  }
+  struct stat info;
+  if (fstat(fd, &info) != 0) {
+    ::close(fd);
+    return false;
+  }
+
+  bool is_new = (info.st_size == 0);
+  std::size_t size = static_cast<std::size_t>(info.st_size);
+  if (is_new) {
+    size = mapped_size(a_capacity);
+    if (ftruncate(fd, static_cast<off_t>(size)) != 0) {
+      ::close(fd);
+      return false;
+    }
+  } else if (size < sizeof(curve_registry_header_t)) {
+    ::close(fd);
+    return false;
+  }
+
+  void* mapping = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (mapping == MAP_FAILED) {
+    return false;
+  }
+  curve_registry_header_t* header = static_cast<curve_registry_header_t*>(mapping);
+
+  if (is_new) {
+    //The object is zero filled by ftruncate, that is a valid empty state
+    header->layout_version = registry_layout_version;
+    header->capacity = a_capacity;
+    header->magic.store(registry_magic, std::memory_order_release);
+  } else if ((header->magic.load(std::memory_order_acquire) != registry_magic) ||
+      (header->layout_version != registry_layout_version) ||
+      (header->capacity < a_capacity) ||
+      (size < mapped_size(static_cast<std::size_t>(header->capacity)))) {
+    munmap(mapping, size);
+    return false;
+  }
+
+  mp_header = header;
+  m_mapped_size = size;
+  return true;
+}
+
+void curve_writer_t::close()
+{
+  if (mp_header) {
+    munmap(mp_header, m_mapped_size);
+    mp_header = nullptr;
+    m_mapped_size = 0;
+  }
+}
+
+bool curve_writer_t::is_open() const
+{
+  return mp_header != nullptr;
+}
+
+bool curve_writer_t::publish(const piecewise_cubic_t& a_curve, std::uint64_t a_version)
+{
+  if (!mp_header) {
+    return false;
+  }
+  const std::size_t knot_count = a_curve.knots.size();
+  if ((knot_count < 2) || (knot_count > mp_header->capacity) ||
+      (a_curve.coeffs.size() != (knot_count + 1) * piecewise_cubic_t::coeffs_per_segment)) {
+    return false;
+  }
+
+  //Readers of the current generation use the other slot
+  const std::uint64_t generation = mp_header->generation.load(std::memory_order_relaxed) + 1;
+  const std::size_t slot = generation % 2;
+  curve_registry_slot_t& slot_header = mp_header->slots[slot];
+
+  const std::uint64_t sequence = slot_header.sequence.load(std::memory_order_relaxed);
+  slot_header.sequence.store(sequence + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  double* knots = slot_data(mp_header, slot);
+  std::memcpy(knots, a_curve.knots.data(), knot_count * sizeof(double));
+  std::memcpy(knots + mp_header->capacity, a_curve.coeffs.data(),
+    a_curve.coeffs.size() * sizeof(double));
+  slot_header.version = a_version;
+  slot_header.knot_count = knot_count;
+  slot_header.period = a_curve.period;
+
+  slot_header.sequence.store(sequence + 2, std::memory_order_release);
+  mp_header->generation.store(generation, std::memory_order_release);
+  return true;
+}
+
+bool curve_writer_t::remove(const std::string& a_name)
+{
+  return is_valid_name(a_name) && (shm_unlink(object_name(a_name).c_str()) == 0);
+}
+
+curve_reader_t::curve_reader_t():
+  mp_header(nullptr),
+  m_mapped_size(0)
+{
+}
+
+curve_reader_t::~curve_reader_t()
+{
+  close();
+}
+
+bool curve_reader_t::open(const std::string& a_name)
+{
+  close();
+  if (!is_valid_name(a_name)) {
+    return false;
+  }
+  int fd = shm_open(object_name(a_name).c_str(), O_RDONLY, 0);
+  if (fd < 0) {
+    return false;
+  }
+  struct stat info;
+  if ((fstat(fd, &info) != 0) ||
+      (static_cast<std::size_t>(info.st_size) < sizeof(curve_registry_header_t))) {
+    ::close(fd);
+    return false;
+  }
+  const std::size_t size = static_cast<std::size_t>(info.st_size);
+  void* mapping = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (mapping == MAP_FAILED) {
+    return false;
+  }
+
+  const curve_registry_header_t* header = static_cast<const curve_registry_header_t*>(mapping);
+  if ((header->magic.load(std::memory_order_acquire) != registry_magic) ||
+      (header->layout_version != registry_layout_version) ||
+      (size < mapped_size(static_cast<std::size_t>(header->capacity)))) {
+    munmap(mapping, size);
+    return false;
+  }
+  mp_header = header;
+  m_mapped_size = size;
+  return true;
+}
+
+void curve_reader_t::close()
+{
+  if (mp_header) {
+    munmap(const_cast<curve_registry_header_t*>(mp_header), m_mapped_size);
+    mp_header = nullptr;
+    m_mapped_size = 0;
+  }
+}
+
+bool curve_reader_t::is_open() const
+{
+  return mp_header != nullptr;
+}
+
+std::uint64_t curve_reader_t::version() const
+{
+  std::uint64_t version = 0;
+  if (mp_header) {
+    read_consistent(mp_header, [&](const curve_registry_slot_t& a_slot, const double*,
+        const double*, std::size_t) {
+      version = a_slot.version;
+    });
+  }
+  return version;
+}
+
+double curve_reader_t::operator()(double a_x) const
+{
+  double y = std::numeric_limits<double>::quiet_NaN();
+  if (mp_header) {
+    read_consistent(mp_header, [&](const curve_registry_slot_t& a_slot, const double* a_knots,
+        const double* a_coeffs, std::size_t a_knot_count) {
+      y = piecewise_cubic_value(a_knots, a_coeffs, a_knot_count, a_slot.period, a_x);
+    });
+  }
+  return y;
+}
+
+void curve_reader_t::calc_array(const double* a_x, double* a_y, std::size_t a_count) const
+{
+  bool published = mp_header && read_consistent(mp_header, [&](const curve_registry_slot_t& a_slot,
+      const double* a_knots, const double* a_coeffs, std::size_t a_knot_count) {
+    for (std::size_t i = 0; i < a_count; i++) {
+      a_y[i] = piecewise_cubic_value(a_knots, a_coeffs, a_knot_count, a_slot.period, a_x[i]);
+    }
+  });
+  if (!published) {
+    std::fill(a_y, a_y + a_count, std::numeric_limits<double>::quiet_NaN());
+  }
+}
@@ -0,0 +1,66 @@
+#ifndef CURVE_REGISTRY_H
+#define CURVE_REGISTRY_H
+
+#include "piecewise_cubic.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+//Publishing of fitted curves into POSIX shared memory, one object per name.
+//The object holds two coefficient slots. The writer fills the slot readers
+//do not use and then switches the generation counter, so a refit becomes
+//visible at once. Readers evaluate straight from the mapping, never lock and
+//only repeat an evaluation if two refits happened while it was running.
+//Each slot has its own sequence counter (seqlock) to detect that case
+
+struct curve_registry_header_t;
+
+class curve_writer_t
+{
+public:
+  curve_writer_t();
+  ~curve_writer_t();
+  curve_writer_t(const curve_writer_t&) = delete;
+  curve_writer_t& operator=(const curve_writer_t&) = delete;
+
+  //Creates the object for curves up to a_capacity knots or opens an existing
+  //one with at least that capacity. Only one writer per name is allowed.
+  //a_mode are the permissions of a new object, write access for the group and
+  //others is always dropped, readers only need read access.
+  //Names must not be empty or contain '/'
+  bool open(const std::string& a_name, std::size_t a_capacity, unsigned a_mode = 0644);
+  void close();
+  bool is_open() const;
+  //False if the curve does not fit into the capacity
+  bool publish(const piecewise_cubic_t& a_curve, std::uint64_t a_version);
+
+  //Removes the name, existing mappings stay valid until closed
+  static bool remove(const std::string& a_name);
+private:
+  curve_registry_header_t* mp_header;
+  std::size_t m_mapped_size;
+};
+
+class curve_reader_t
+{
+public:
+  curve_reader_t();
+  ~curve_reader_t();
+  curve_reader_t(const curve_reader_t&) = delete;
+  curve_reader_t& operator=(const curve_reader_t&) = delete;
+
+  bool open(const std::string& a_name);
+  void close();
+  bool is_open() const;
+  //Version passed to publish, 0 if nothing is published yet
+  std::uint64_t version() const;
+  //NaN if nothing is published yet
+  double operator()(double a_x) const;
+  void calc_array(const double* a_x, double* a_y, std::size_t a_count) const;
+private:
+  const curve_registry_header_t* mp_header;
+  std::size_t m_mapped_size;
+};
+
+#endif // CURVE_REGISTRY_H
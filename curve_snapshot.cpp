@@ -0,0 +1,84 @@
+#include "curve_snapshot.h"
+
+#include <cassert>
+#include <limits>
+
+curve_snapshot_t::curve_snapshot_t(piecewise_cubic_t a_curve, std::uint64_t a_version):
+  m_curve(std::move(a_curve)),
+  m_version(a_version)
+{
+  assert(m_curve.knots.size() >= 2);
+  assert(m_curve.coeffs.size() ==
+    (m_curve.knots.size() + 1) * piecewise_cubic_t::coeffs_per_segment);
+}
+
+std::uint64_t curve_snapshot_t::version() const
+{
+  return m_version;
+}
+
+const piecewise_cubic_t& curve_snapshot_t::curve() const
+{
+  return m_curve;
+}
+
+double curve_snapshot_t::operator()(double a_x) const
+{
+  return piecewise_cubic_value(m_curve, a_x);
+}
+
+void curve_snapshot_t::calc_array(const double* a_x, double* a_y, std::size_t a_count) const
+{
+  for (std::size_t i = 0; i < a_count; i++) {
+    a_y[i] = piecewise_cubic_value(m_curve, a_x[i]);
+  }
+}
+
+curve_handle_t::curve_handle_t():
+  mp_snapshot(),
+  m_generation(0)
+{
+}
+
+void curve_handle_t::publish(std::shared_ptr<const curve_snapshot_t> a_snapshot)
+{
+  std::atomic_store_explicit(&mp_snapshot, std::move(a_snapshot), std::memory_order_release);
+  m_generation.fetch_add(1, std::memory_order_release);
+}
+
+std::shared_ptr<const curve_snapshot_t> curve_handle_t::load() const
+{
+  return std::atomic_load_explicit(&mp_snapshot, std::memory_order_acquire);
+}
+
+std::uint64_t curve_handle_t::generation() const
+{
+  return m_generation.load(std::memory_order_acquire);
+}
+
+curve_view_t::curve_view_t(const curve_handle_t& a_handle):
+  m_handle(a_handle),
+  mp_snapshot(),
+  m_generation(0)
+{
+}
+
+const curve_snapshot_t* curve_view_t::snapshot()
+{
+  std::uint64_t generation = m_handle.generation();
+  if (generation != m_generation) {
+    //A publish between the two loads only makes the next call reload again
+    m_generation = generation;
+    mp_snapshot = m_handle.load();
+  }
+  return mp_snapshot.get();
+}
+
+double curve_view_t::operator()(double a_x)
+{
+  const curve_snapshot_t* current = snapshot();
+  if (!current) {
+    return std::numeric_limits<double>::quiet_NaN();
+  }
+  return (*current)(a_x);
+}
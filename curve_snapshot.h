@@ -0,0 +1,74 @@
+#ifndef CURVE_SNAPSHOT_H
+#define CURVE_SNAPSHOT_H
+
+#include "piecewise_cubic.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+//Fitted curve that is never changed after construction,
+//so any number of threads can evaluate it without locks
+class curve_snapshot_t
+{
+public:
+  curve_snapshot_t(piecewise_cubic_t a_curve, std::uint64_t a_version);
+
+  std::uint64_t version() const;
+  const piecewise_cubic_t& curve() const;
+  double operator()(double a_x) const;
+  void calc_array(const double* a_x, double* a_y, std::size_t a_count) const;
+private:
+  const piecewise_cubic_t m_curve;
+  const std::uint64_t m_version;
+};
+
+//Fits are exported through export_piecewise (tk::spline, pchip_t)
+template <class I>
+std::shared_ptr<const curve_snapshot_t> make_curve_snapshot(const I& a_interpolation,
+  std::uint64_t a_version)
+{
+  piecewise_cubic_t curve;
+  a_interpolation.export_piecewise(curve);
+  return std::make_shared<const curve_snapshot_t>(std::move(curve), a_version);
+}
+
+//Current snapshot of a curve that is refitted while other threads evaluate it.
+//The writer fits into a new snapshot and publishes it, a reader keeps
+//the snapshot it got alive until it drops the pointer
+class curve_handle_t
+{
+public:
+  curve_handle_t();
+  curve_handle_t(const curve_handle_t&) = delete;
+  curve_handle_t& operator=(const curve_handle_t&) = delete;
+
+  void publish(std::shared_ptr<const curve_snapshot_t> a_snapshot);
+  //Null until the first publish
+  std::shared_ptr<const curve_snapshot_t> load() const;
+  //Changes on every publish, reading it never locks
+  std::uint64_t generation() const;
+private:
+  std::shared_ptr<const curve_snapshot_t> mp_snapshot;
+  std::atomic<std::uint64_t> m_generation;
+};
+
+//Per-thread reader of a handle. The shared pointer is loaded again only
+//after a publish, otherwise a read costs one atomic load of the generation
+class curve_view_t
+{
+public:
+  explicit curve_view_t(const curve_handle_t& a_handle);
+
+  //Null until the first publish
+  const curve_snapshot_t* snapshot();
+  //NaN until the first publish
+  double operator()(double a_x);
+private:
+  const curve_handle_t& m_handle;
+  std::shared_ptr<const curve_snapshot_t> mp_snapshot;
+  std::uint64_t m_generation;
+};
+
+#endif // CURVE_SNAPSHOT_H
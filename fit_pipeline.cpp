@@ -0,0 +1,139 @@
+#include "fit_pipeline.h"
+#include "instrumentation.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+//How many samples are calculated between two cancellation checks
+constexpr std::size_t cancel_check_period = 4096;
+
+} // namespace
+
+double relative_deviation(double a_real, double a_calculated)
+{
+  return (a_real - a_calculated) / a_calculated * 100;
+}
+
+deviation_stats_t::deviation_stats_t():
+  count(0),
+  non_finite(0),
+  max_abs(0),
+  max_abs_x(std::numeric_limits<double>::quiet_NaN()),
+  sum_abs(0),
+  sum_squares(0)
+{
+}
+
+void deviation_stats_t::add(double a_x, double a_deviation)
+{
+  double deviation = std::abs(a_deviation);
+  if (!std::isfinite(deviation)) {
+    non_finite++;
+    return;
+  }
+  if ((count == 0) || (deviation > max_abs)) {
+    max_abs = deviation;
+    max_abs_x = a_x;
+  }
+  sum_abs += deviation;
+  sum_squares += deviation * deviation;
+  count++;
+}
+
+void deviation_stats_t::merge(const deviation_stats_t& a_other)
+{
+  if ((a_other.count != 0) && ((count == 0) || (a_other.max_abs > max_abs))) {
+    max_abs = a_other.max_abs;
+    max_abs_x = a_other.max_abs_x;
+  }
+  count += a_other.count;
+  non_finite += a_other.non_finite;
+  sum_abs += a_other.sum_abs;
+  sum_squares += a_other.sum_squares;
+}
+
+double deviation_stats_t::mean_abs() const
+{
+  return (count == 0) ? 0 : sum_abs / static_cast<double>(count);
+}
+
+double deviation_stats_t::rms() const
+{
+  return (count == 0) ? 0 : std::sqrt(sum_squares / static_cast<double>(count));
+}
+
+bool is_same_fit(const fit_job_t& a_left, const fit_job_t& a_right)
+{
+  return (a_left.series_id != 0) &&
+    (a_left.series_id == a_right.series_id) &&
+    (a_left.knots == a_right.knots) &&
+    (a_left.enable == a_right.enable) &&
+    (a_left.min_x == a_right.min_x) &&
+    (a_left.max_x == a_right.max_x) &&
+    (a_left.step == a_right.step);
+}
+
+bool run_fit_job(const fit_job_t& a_job, fit_result_t& a_result,
+  const std::function<bool()>& a_is_cancelled)
+{
+  SPLINES_SCOPED_TIMER(itm_fit_job);
+  assert(a_job.points);
+  const std::vector<double>& x = a_job.points->x;
+  const std::vector<double>& y = a_job.points->y;
+  assert(x.size() == y.size());
+
+  std::vector<double> correct_x;
+  std::vector<double> correct_y;
+  a_job.knots.gather(x, correct_x);
+  a_job.knots.gather(y, correct_y);
+
+  a_result.sample_x.clear();
+  if (a_job.step > 0) {
+    for (double sample = a_job.min_x; sample < a_job.max_x; sample += a_job.step) {
+      a_result.sample_x.push_back(sample);
+    }
+  }
+
+  for (size_t type = 0; type < it_count; type++) {
+    std::vector<double>& sample_y = a_result.sample_y[type];
+    std::vector<double>& deviations = a_result.deviations[type];
+    sample_y.clear();
+    deviations.clear();
+
+    if (!a_job.enable[type] || correct_x.size() < 2) {
+      continue;
+    }
+    if (a_is_cancelled()) {
+      return false;
+    }
+
+    std::unique_ptr<interpolation_base_t> interpolation =
+      make_interpolation(static_cast<interpolation_type_t>(type));
+    {
+      SPLINES_SCOPED_TIMER_TAG(itm_interp_fit, static_cast<unsigned>(type));
+      interpolation->set_points(correct_x.data(), correct_y.data(), correct_x.size());
+    }
+
+    SPLINES_SCOPED_TIMER_TAG(itm_interp_sampling, static_cast<unsigned>(type));
+    deviations.resize(x.size());
+    interpolation->calc_array(x.data(), deviations.data(), x.size());
+    for (size_t i = 0; i < x.size(); i++) {
+      deviations[i] = relative_deviation(y[i], deviations[i]);
+    }
+
+    const size_t sample_count = a_result.sample_x.size();
+    sample_y.resize(sample_count);
+    for (size_t begin = 0; begin < sample_count; begin += cancel_check_period) {
+      if (a_is_cancelled()) {
+        return false;
+      }
+      size_t count = std::min(cancel_check_period, sample_count - begin);
+      interpolation->calc_array(a_result.sample_x.data() + begin, sample_y.data() + begin, count);
+    }
+  }
+  return true;
+}
@@ -0,0 +1,94 @@
+#ifndef FIT_PIPELINE_H
+#define FIT_PIPELINE_H
+
+#include "interpolation_factory.h"
+#include "knot_subset.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+//Input data is shared between jobs and must not be changed after submit
+struct fit_points_t
+{
+  std::vector<double> x;
+  std::vector<double> y;
+};
+
+struct fit_job_t
+{
+  std::size_t generation;
+  //Identifies the source row/column of points, 0 if the job must not be cached
+  std::uint64_t series_id;
+  std::shared_ptr<const fit_points_t> points;
+  //Points used as knots, indices into points->x
+  knot_subset_t knots;
+  std::array<bool, it_count> enable;
+  double min_x;
+  double max_x;
+  double step;
+
+  fit_job_t():
+    generation(0),
+    series_id(0),
+    points(),
+    knots(),
+    enable(),
+    min_x(0),
+    max_x(0),
+    step(0)
+  {
+  }
+};
+
+struct fit_result_t
+{
+  std::vector<double> sample_x;
+  //Indexed by interpolation_type_t, empty if the interpolation is disabled
+  std::array<std::vector<double>, it_count> sample_y;
+  //Deviation in every input point, same indexing as sample_y
+  std::array<std::vector<double>, it_count> deviations;
+
+  fit_result_t():
+    sample_x(),
+    sample_y(),
+    deviations()
+  {
+  }
+};
+
+//Absolute values of relative_deviation over the points of one fit.
+//NaN and infinite deviations (the fit is 0 in the point) are only counted
+//in non_finite, so that one such point does not hide all the others
+struct deviation_stats_t
+{
+  std::size_t count;
+  std::size_t non_finite;
+  double max_abs;
+  //X of the point with max_abs
+  double max_abs_x;
+  double sum_abs;
+  double sum_squares;
+
+  deviation_stats_t();
+  void add(double a_x, double a_deviation);
+  void merge(const deviation_stats_t& a_other);
+  double mean_abs() const;
+  double rms() const;
+};
+
+double relative_deviation(double a_real, double a_calculated);
+
+//True if both jobs fit the same series with the same parameters,
+//so the result of one of them can be used for the other
+bool is_same_fit(const fit_job_t& a_left, const fit_job_t& a_right);
+
+//Fits every enabled interpolation, samples it and calculates deviations.
+//Returns false if a_is_cancelled() reported that the job became stale
+bool run_fit_job(const fit_job_t& a_job, fit_result_t& a_result,
+  const std::function<bool()>& a_is_cancelled);
+
+#endif // FIT_PIPELINE_H
@@ -0,0 +1,185 @@
+#include "fit_worker.h"
+
+#include <QMutexLocker>
+#include <QRunnable>
+#include <QThread>
+
+class fit_task_t : public QRunnable
+{
+public:
+  fit_task_t(fit_worker_t* ap_worker, fit_job_t a_job, bool a_prefetch,
+    std::size_t a_prefetch_round):
+    mp_worker(ap_worker),
+    m_job(std::move(a_job)),
+    m_prefetch(a_prefetch),
+    m_prefetch_round(a_prefetch_round)
+  {
+  }
+
+  void run() override
+  {
+    auto is_cancelled = [this]() {
+      if (m_prefetch) {
+        return mp_worker->m_prefetch_round != m_prefetch_round;
+      }
+      return mp_worker->generation() != m_job.generation;
+    };
+    std::shared_ptr<fit_result_t> result = std::make_shared<fit_result_t>();
+    if (run_fit_job(m_job, *result, is_cancelled)) {
+      mp_worker->store_cached(m_job, result);
+      if (!m_prefetch && !is_cancelled()) {
+        emit mp_worker->fit_done(m_job.generation, result);
+      }
+    }
+  }
+
+private:
+  fit_worker_t* mp_worker;
+  fit_job_t m_job;
+  bool m_prefetch;
+  std::size_t m_prefetch_round;
+};
+
+class table_fit_task_t : public QRunnable
+{
+public:
+  table_fit_task_t(fit_worker_t* ap_worker, std::shared_ptr<const table_t> a_table,
+    table_fit_options_t a_options, std::size_t a_generation):
+    mp_worker(ap_worker),
+    m_table(std::move(a_table)),
+    m_options(std::move(a_options)),
+    m_generation(a_generation)
+  {
+  }
+
+  void run() override
+  {
+    m_options.is_cancelled = [this]() {
+      return mp_worker->table_generation() != m_generation;
+    };
+    std::vector<series_fit_t> results = fit_table(*m_table, m_options);
+    if (m_options.is_cancelled()) {
+      return;
+    }
+    std::shared_ptr<table_fit_result_t> result = std::make_shared<table_fit_result_t>();
+    result->report = table_fit_report(results, m_options.select);
+    result->summary = table_fit_summary(results, m_options.select);
+    emit mp_worker->table_fit_done(m_generation, result);
+  }
+
+private:
+  fit_worker_t* mp_worker;
+  std::shared_ptr<const table_t> m_table;
+  table_fit_options_t m_options;
+  std::size_t m_generation;
+};
+
+fit_worker_t::fit_worker_t(QObject *parent) :
+  QObject(parent),
+  m_pool(),
+  m_generation(0),
+  m_prefetch_round(0),
+  m_table_generation(0),
+  m_cache_mutex(),
+  m_cache()
+{
+  qRegisterMetaType<std::size_t>("std::size_t");
+  qRegisterMetaType<std::shared_ptr<const fit_result_t>>();
+  qRegisterMetaType<std::shared_ptr<const table_fit_result_t>>();
+  m_pool.setMaxThreadCount(QThread::idealThreadCount());
+}
+
+fit_worker_t::~fit_worker_t()
+{
+  //Running jobs see the new generation and stop at the next check
+  m_generation++;
+  m_prefetch_round++;
+  m_table_generation++;
+  m_pool.waitForDone();
+}
+
+std::size_t fit_worker_t::submit(fit_job_t a_job)
+{
+  a_job.generation = ++m_generation;
+  std::size_t generation = a_job.generation;
+
+  std::shared_ptr<const fit_result_t> cached = find_cached(a_job);
+  if (cached) {
+    emit fit_done(generation, cached);
+  } else {
+    m_pool.start(new fit_task_t(this, std::move(a_job), false, 0), submit_priority);
+  }
+  return generation;
+}
+
+std::size_t fit_worker_t::generation() const
+{
+  return m_generation;
+}
+
+void fit_worker_t::start_prefetch_round()
+{
+  m_prefetch_round++;
+}
+
+void fit_worker_t::prefetch(fit_job_t a_job)
+{
+  if ((a_job.series_id == 0) || find_cached(a_job)) {
+    return;
+  }
+  m_pool.start(new fit_task_t(this, std::move(a_job), true, m_prefetch_round),
+    prefetch_priority);
+}
+
+std::size_t fit_worker_t::submit_table(std::shared_ptr<const table_t> a_table,
+  table_fit_options_t a_options)
+{
+  std::size_t generation = ++m_table_generation;
+  //fit_table starts its own threads, the task only holds one thread of the pool
+  m_pool.start(new table_fit_task_t(this, std::move(a_table), std::move(a_options), generation),
+    submit_priority);
+  return generation;
+}
+
+std::size_t fit_worker_t::table_generation() const
+{
+  return m_table_generation;
+}
+
+std::shared_ptr<const fit_result_t> fit_worker_t::find_cached(const fit_job_t& a_job)
+{
+  QMutexLocker lock(&m_cache_mutex);
+  for (auto it = m_cache.begin(); it != m_cache.end(); ++it) {
+    if (is_same_fit(it->job, a_job)) {
+      cache_entry_t entry = std::move(*it);
+      m_cache.erase(it);
+      m_cache.push_front(std::move(entry));
+      return m_cache.front().result;
+    }
+  }
+  return nullptr;
+}
+
+void fit_worker_t::store_cached(const fit_job_t& a_job, std::shared_ptr<const fit_result_t> a_result)
+{
+  if (a_job.series_id == 0) {
+    return;
+  }
+  cache_entry_t entry;
+  entry.job = a_job;
+  //Points are not needed for comparison, no reason to keep them alive
+  entry.job.points.reset();
+  entry.result = std::move(a_result);
+
+  QMutexLocker lock(&m_cache_mutex);
+  for (auto it = m_cache.begin(); it != m_cache.end(); ++it) {
+    if (is_same_fit(it->job, a_job)) {
+      m_cache.erase(it);
+      break;
+    }
+  }
+  m_cache.push_front(std::move(entry));
+  if (m_cache.size() > cache_size) {
+    m_cache.pop_back();
+  }
+}
@@ -0,0 +1,74 @@
+#ifndef FIT_WORKER_H
+#define FIT_WORKER_H
+
+#include <QObject>
+#include <QMutex>
+#include <QThreadPool>
+
+#include <atomic>
+#include <deque>
+#include <memory>
+
+#include "fit_pipeline.h"
+#include "table_fit.h"
+
+Q_DECLARE_METATYPE(std::shared_ptr<const fit_result_t>)
+Q_DECLARE_METATYPE(std::shared_ptr<const table_fit_result_t>)
+
+class fit_worker_t : public QObject
+{
+  Q_OBJECT
+public:
+  explicit fit_worker_t(QObject *parent = nullptr);
+  ~fit_worker_t();
+
+  //Cancels all previously submitted jobs, returns the generation of the new one.
+  //If the same fit was already calculated, the cached result is delivered
+  std::size_t submit(fit_job_t a_job);
+  std::size_t generation() const;
+
+  //Speculative jobs only fill the cache, fit_done is not emitted for them.
+  //A new round cancels unfinished jobs of the previous one
+  void start_prefetch_round();
+  void prefetch(fit_job_t a_job);
+
+  //Fits the whole table in the pool and builds the report there.
+  //Cancels the previous table fit, returns the generation of the new one
+  std::size_t submit_table(std::shared_ptr<const table_t> a_table, table_fit_options_t a_options);
+  std::size_t table_generation() const;
+
+signals:
+  //Emitted from a pool thread, must be connected with Qt::QueuedConnection
+  void fit_done(std::size_t a_generation, std::shared_ptr<const fit_result_t> a_result);
+  //Same as fit_done, a_generation is the one returned by submit_table
+  void table_fit_done(std::size_t a_generation, std::shared_ptr<const table_fit_result_t> a_result);
+
+private:
+  enum {
+    cache_size = 16,
+    submit_priority = 1,
+    prefetch_priority = 0
+  };
+
+  struct cache_entry_t {
+    fit_job_t job;
+    std::shared_ptr<const fit_result_t> result;
+  };
+
+  QThreadPool m_pool;
+  std::atomic<std::size_t> m_generation;
+  std::atomic<std::size_t> m_prefetch_round;
+  std::atomic<std::size_t> m_table_generation;
+
+  mutable QMutex m_cache_mutex;
+  //Most recently used entries are at the front
+  std::deque<cache_entry_t> m_cache;
+
+  std::shared_ptr<const fit_result_t> find_cached(const fit_job_t& a_job);
+  void store_cached(const fit_job_t& a_job, std::shared_ptr<const fit_result_t> a_result);
+
+  friend class fit_task_t;
+  friend class table_fit_task_t;
+};
+
+#endif // FIT_WORKER_H
@@ -2,42 +2,85 @@
 #define HERMIT_H
 
 #include "interpolation_base.h"
+#include "cubic_eval.h"
+#include "instrumentation.h"
+#include "inverse_search.h"
+#include "piecewise_cubic.h"
+#include "segment_search.h"
 
 #include <vector>
 #include <cassert>
+#include <cmath>
+#include <memory_resource>
 using namespace std;
 
 
-//Piecewise Cubic Hermite Interpolating Polynomial
+//Piecewise Cubic Hermite Interpolating Polynomial.
+//All vectors are allocated from the memory resource given to the constructor
 template <class T>
 class pchip_t : public interpolation_base_t
 {
 public:
     pchip_t();
+    explicit pchip_t(pmr::memory_resource* a_resource);
     virtual ~pchip_t() override;
     virtual void set_points(const T *a_x, const T *a_y, size_t a_length) override;
     virtual T operator()(T a_x) override;
+    virtual void calc_array(const T* a_x, T* a_y, size_t a_count) override;
+    virtual interpolation_derivs_t calc_derivs(T a_x) override;
+    virtual void calc_derivs_array(const T* a_x, T* a_value, T* a_first,
+      T* a_second, size_t a_count) override;
+    //Copy of the first derivatives in the knots, valid after set_points.
+    //A pmr allocator keeps the copy in the arena of the caller
+    template <class A = allocator<T>>
+    vector<T, A> knot_derivatives(const A& a_allocator = A()) const;
+    //Solves f(x) = y between the knots, NaN if y is outside of the knot values.
+    //For non-monotone data the root in the first segment whose knot values
+    //bracket y is returned. Pchip segments do not overshoot their knot values,
+    //so this is also the root with the smallest x
+    T inverse(T a_y) const;
+    void inverse(const T* a_y, T* a_x, size_t a_count) const;
+    //Integral from a_a to a_b in closed form, O(log n) via prefix sums
+    T integrate(T a_a, T a_b) const;
+    void integrate(const T* a_from, const T* a_to, T* a_result, size_t a_count) const;
+    //Coefficients in the interpolation independent form, see piecewise_cubic_t
+    void export_piecewise(piecewise_cubic_t& a_curve) const;
 private:
     size_t m_nodes_count;
-    vector<T> m_x;
-    vector<T> m_y;
-    vector<T> m_derivatives;
+    pmr::vector<T> m_x;
+    pmr::vector<T> m_y;
+    pmr::vector<T> m_derivatives;
 
-    vector<T> m_c2;
-    vector<T> m_c3;
+    pmr::vector<T> m_c2;
+    pmr::vector<T> m_c3;
+
+    monotone_index_t<T> m_inverse_index;
+    //Integral from m_x[0] to m_x[i]
+    pmr::vector<T> m_integral;
 
     void spline_pchip_set();
     T get_multi_sign (T a_a, T b_b);
+    T calc_segment(size_t a_interval_num, T a_x) const;
+    T calc_segment_integral(size_t a_interval_num, T a_x) const;
+    T primitive(T a_x) const;
 };
 
 template <class T>
 pchip_t<T>::pchip_t() :
+  pchip_t(pmr::get_default_resource())
+{
+}
+
+template <class T>
+pchip_t<T>::pchip_t(pmr::memory_resource* a_resource) :
   m_nodes_count(0),
-  m_x(),
-  m_y(),
-  m_derivatives(),
-  m_c2(),
-  m_c3()
+  m_x(a_resource),
+  m_y(a_resource),
+  m_derivatives(a_resource),
+  m_c2(a_resource),
+  m_c3(a_resource),
+  m_inverse_index(a_resource),
+  m_integral(a_resource)
 {
 
 }
@@ -50,9 +93,11 @@ pchip_t<T>::~pchip_t()
 template <class T>
 void pchip_t<T>::set_points(const T* a_x, const T* a_y, size_t a_length)
 {
+  SPLINES_SCOPED_TIMER(itm_set_points);
+  SPLINES_COUNT(ic_fits);
   assert(a_length >= 2);
   for (size_t i = 1; i < a_length; i++) {
-    assert(a_x[i] >= a_x[i - 1]);
+    assert(a_x[i] > a_x[i - 1]);
   }
 
   if (m_nodes_count != a_length) {
@@ -68,6 +113,13 @@ void pchip_t<T>::set_points(const T* a_x, const T* a_y, size_t a_length)
   std::copy(a_y, a_y + a_length, m_y.begin());
 
   spline_pchip_set();
+  m_inverse_index.build(m_y);
+
+  m_integral.resize(m_nodes_count);
+  m_integral[0] = 0;
+  for (size_t i = 0; i < m_nodes_count - 1; i++) {
+    m_integral[i + 1] = m_integral[i] + calc_segment_integral(i, m_x[i + 1]);
+  }
 }
 
 template <class T>
@@ -183,30 +235,148 @@ void pchip_t<T>::spline_pchip_set()
   }
 }
 
+template <class T>
+template <class A>
+vector<T, A> pchip_t<T>::knot_derivatives(const A& a_allocator) const
+{
+  return vector<T, A>(m_derivatives.begin(), m_derivatives.end(), a_allocator);
+}
+
+template <class T>
+T pchip_t<T>::inverse(T a_y) const
+{
+  size_t interval_num = 0;
+  if (!m_nodes_count || !m_inverse_index.find(m_y, a_y, interval_num)) {
+    return std::numeric_limits<T>::quiet_NaN();
+  }
+  T h = solve_segment_cubic(m_y[interval_num], m_derivatives[interval_num],
+    m_c2[interval_num], m_c3[interval_num],
+    m_x[interval_num + 1] - m_x[interval_num], a_y);
+  return m_x[interval_num] + h;
+}
+
+template <class T>
+void pchip_t<T>::inverse(const T* a_y, T* a_x, size_t a_count) const
+{
+  for (size_t i = 0; i < a_count; i++) {
+    a_x[i] = inverse(a_y[i]);
+  }
+}
+
+template <class T>
+T pchip_t<T>::calc_segment_integral(size_t a_interval_num, T a_x) const
+{
+  //Antiderivative of the segment polynomial, zero in m_x[a_interval_num]
+  T x = a_x - m_x[a_interval_num];
+  return x * (m_y[a_interval_num] + x * (m_derivatives[a_interval_num] / 2 +
+    x * (m_c2[a_interval_num] / 3 + x * m_c3[a_interval_num] / 4)));
+}
+
+template <class T>
+T pchip_t<T>::primitive(T a_x) const
+{
+  //Extrapolation continues the first/last segment, so the same formula works
+  size_t interval_num = find_segment(m_x, a_x);
+  return m_integral[interval_num] + calc_segment_integral(interval_num, a_x);
+}
+
+template <class T>
+T pchip_t<T>::integrate(T a_a, T a_b) const
+{
+  assert(m_nodes_count);
+  return primitive(a_b) - primitive(a_a);
+}
+
+template <class T>
+void pchip_t<T>::integrate(const T* a_from, const T* a_to, T* a_result, size_t a_count) const
+{
+  for (size_t i = 0; i < a_count; i++) {
+    a_result[i] = integrate(a_from[i], a_to[i]);
+  }
+}
+
+template <class T>
+T pchip_t<T>::calc_segment(size_t a_interval_num, T a_x) const
+{
+  T x = a_x - m_x[a_interval_num];
+  T y = m_y[a_interval_num] + x * (m_derivatives[a_interval_num] +
+    x * (m_c2[a_interval_num] + x * m_c3[a_interval_num]));
+  return y;
+}
+
 template <class T>
 T pchip_t<T>::operator()(T a_x)
 {
+  SPLINES_COUNT(ic_evaluations);
   assert(m_nodes_count);
+  return calc_segment(find_segment(m_x, a_x), a_x);
+}
 
-  int interval_num = -1;
-  if (a_x <= m_x[0]) {
-    interval_num = 0;
-  } else if (a_x >= m_x[m_nodes_count - 1]) {
-    interval_num = m_nodes_count - 2;
-  } else {
-    for (size_t i = 1; i < m_nodes_count; i++) {
-      if (m_x[i] > a_x) {
-        interval_num = i - 1;
-        break;
-      }
-    }
+template <class T>
+void pchip_t<T>::calc_array(const T* a_x, T* a_y, size_t a_count)
+{
+  SPLINES_COUNT_N(ic_evaluations, a_count);
+  assert(m_nodes_count);
+  size_t interval_num = 0;
+  for (size_t i = 0; i < a_count; i++) {
+    interval_num = find_segment(m_x, a_x[i], interval_num);
+    a_y[i] = calc_segment(interval_num, a_x[i]);
   }
-  assert(interval_num >= 0);
+}
 
+template <class T>
+void pchip_t<T>::export_piecewise(piecewise_cubic_t& a_curve) const
+{
+  assert(m_nodes_count);
+  const size_t n = m_nodes_count;
+  a_curve.knots.assign(m_x.begin(), m_x.end());
+  a_curve.coeffs.resize((n + 1) * piecewise_cubic_t::coeffs_per_segment);
+  a_curve.period = 0;
+  const size_t size = piecewise_cubic_t::coeffs_per_segment;
+  double* c = a_curve.coeffs.data();
+  for (size_t i = 0; i < n - 1; i++) {
+    double* segment = c + (i + 1) * size;
+    segment[0] = m_y[i];
+    segment[1] = m_derivatives[i];
+    segment[2] = m_c2[i];
+    segment[3] = m_c3[i];
+  }
+  //Left extrapolation continues the first interval with the same anchor
+  std::copy(c + size, c + 2 * size, c);
+  //Right one continues the last interval, re-anchored at the last knot
+  double* right = c + n * size;
+  T h = m_x[n - 1] - m_x[n - 2];
+  T c2 = m_c2[n - 2];
+  T c3 = m_c3[n - 2];
+  right[0] = m_y[n - 1];
+  right[1] = m_derivatives[n - 2] + h * (2 * c2 + h * 3 * c3);
+  right[2] = c2 + 3 * c3 * h;
+  right[3] = c3;
+}
+
+template <class T>
+interpolation_derivs_t pchip_t<T>::calc_derivs(T a_x)
+{
+  assert(m_nodes_count);
+  size_t interval_num = find_segment(m_x, a_x);
   T x = a_x - m_x[interval_num];
-  T y = m_y[interval_num] + x * (m_derivatives[interval_num] +
-    x * (m_c2[interval_num] + x * m_c3[interval_num]));
-  return y;
+  T c1 = m_derivatives[interval_num];
+  T c2 = m_c2[interval_num];
+  T c3 = m_c3[interval_num];
+  interpolation_derivs_t derivs;
+  derivs.value = m_y[interval_num] + x * (c1 + x * (c2 + x * c3));
+  derivs.first = c1 + x * (2 * c2 + x * 3 * c3);
+  derivs.second = 2 * c2 + 6 * c3 * x;
+  return derivs;
+}
+
+template <class T>
+void pchip_t<T>::calc_derivs_array(const T* a_x, T* a_value, T* a_first,
+  T* a_second, size_t a_count)
+{
+  assert(m_nodes_count);
+  calc_cubic_derivs_array(m_x, m_y.data(), m_derivatives.data(), m_c2.data(),
+    m_c3.data(), a_x, a_value, a_first, a_second, a_count);
 }
 
 
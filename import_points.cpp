@@ -1,7 +1,11 @@
 #include "import_points.h"
+#include "input_normalization.h"
 
 #include <QDebug>
 
+#include <algorithm>
+#include <limits>
+
 import_points_t::import_points_t(std::vector<double> &a_correct_points, QObject *parent) :
   QObject(parent),
   m_last_file_name(""),
@@ -10,9 +14,19 @@ import_points_t::import_points_t(std::vector<double> &a_correct_points, QObject
   mp_import_dialog(),
   m_selected(import_points_dialog_t::select_t::none),
   m_selected_row(0),
-  m_selected_col(0)
+  m_selected_col(0),
+  m_table(),
+  m_table_valid(false),
+  m_table_version(1),
+  m_knots()
 {
-
+  //    
+  connect(m_csv_model, &QStandardItemModel::modelReset, this, &import_points_t::invalidate_table);
+  connect(m_csv_model, &QStandardItemModel::rowsInserted, this, &import_points_t::invalidate_table);
+  connect(m_csv_model, &QStandardItemModel::columnsInserted, this, &import_points_t::invalidate_table);
+  connect(m_csv_model, &QStandardItemModel::rowsRemoved, this, &import_points_t::invalidate_table);
+  connect(m_csv_model, &QStandardItemModel::columnsRemoved, this, &import_points_t::invalidate_table);
+  connect(m_csv_model, &QStandardItemModel::dataChanged, this, &import_points_t::invalidate_table);
 }
 
 void import_points_t::create_import_points_dialog(QWidget* a_parent)
@@ -45,96 +59,187 @@ void import_points_t::set_new_col(int a_col)
   m_selected = import_points_dialog_t::select_t::cols;
 }
 
-void import_points_t::fill_x_y_arrays(std::vector<double>& a_x,
-  std::vector<double>& a_y)
+void import_points_t::invalidate_table()
 {
-  switch (m_selected) {
-    case import_points_dialog_t::select_t::rows: {
-      a_x.reserve(static_cast<size_t>(m_csv_model->columnCount() - 1));
-      a_y.reserve(static_cast<size_t>(m_csv_model->columnCount() - 1));
+  if (m_table_valid) {
+    m_table_valid = false;
+    m_table_version++;
+  }
+}
 
-      //  -  Y
-      for(int i = 1; i < m_csv_model->columnCount(); i++) {
-        QString x_str = m_csv_model->item(0, i)->text();
-        a_x.push_back(x_str.replace(",", ".").toDouble());
+void import_points_t::parse_table()
+{
+  if (m_table_valid) {
+    return;
+  }
+  const int rows = m_csv_model->rowCount();
+  const int cols = m_csv_model->columnCount();
+  m_table.rows = static_cast<size_t>(rows);
+  m_table.cols = static_cast<size_t>(cols);
+  m_table.cells.assign(m_table.rows * m_table.cols, std::numeric_limits<double>::quiet_NaN());
 
-        QString y_str = m_csv_model->item(m_selected_row, i)->text();
-        a_y.push_back(y_str.replace(",", ".").toDouble());
+  for (int row = 0; row < rows; row++) {
+    for (int col = 0; col < cols; col++) {
+      QStandardItem* item = m_csv_model->item(row, col);
+      if (item != nullptr) {
+        QString str = item->text();
+        m_table.cells[static_cast<size_t>(row * cols + col)] = str.replace(",", ".").toDouble();
       }
-    } break;
-    case import_points_dialog_t::select_t::cols: {
-      a_x.reserve(static_cast<size_t>(m_csv_model->rowCount() - 1));
-      a_y.reserve(static_cast<size_t>(m_csv_model->rowCount() - 1));
+    }
+  }
+  m_table_valid = true;
+}
+
+const table_t& import_points_t::get_table()
+{
+  parse_table();
+  return m_table;
+}
 
-      //  -  X
-      for(int i = 1; i < m_csv_model->rowCount(); i++) {
-        QString x_str = m_csv_model->item(i, 0)->text();
-        a_x.push_back(x_str.replace(",", ".").toDouble());
+void import_points_t::fill_x_y_arrays(import_points_dialog_t::select_t a_select, int a_index,
+  std::vector<double>& a_x, std::vector<double>& a_y)
+{
+  parse_table();
 
-        QString y_str = m_csv_model->item(i, m_selected_col)->text();
-        a_y.push_back(y_str.replace(",", ".").toDouble());
-      }
+  switch (a_select) {
+    case import_points_dialog_t::select_t::rows: {
+      table_series(m_table, table_select_t::row, static_cast<size_t>(a_index), a_x, a_y);
+    } break;
+    case import_points_dialog_t::select_t::cols: {
+      table_series(m_table, table_select_t::col, static_cast<size_t>(a_index), a_x, a_y);
     } break;
     default: {
     } break;
   }
 }
 
-bool import_points_t::are_correct_points_valid(const std::vector<double> &a_correct_points, const std::vector<double> &a_x)
+bool import_points_t::fill_grid_arrays(std::vector<double> &a_x, std::vector<double> &a_y,
+  std::vector<double> &a_z)
 {
-  if (a_correct_points.size() < 2) {
+  parse_table();
+  if (m_table.rows < 3 || m_table.cols < 3) {
     return false;
   }
-  for (auto point: a_correct_points) {
-    if (std::find(a_x.begin(), a_x.end(), point) == a_x.end()) {
-      return false;
+
+  a_x.clear();
+  a_y.clear();
+  a_z.clear();
+  a_x.reserve(m_table.cols - 1);
+  a_y.reserve(m_table.rows - 1);
+  a_z.reserve((m_table.rows - 1) * (m_table.cols - 1));
+
+  for (size_t col = 1; col < m_table.cols; col++) {
+    a_x.push_back(m_table.cell(0, col));
+  }
+  for (size_t row = 1; row < m_table.rows; row++) {
+    a_y.push_back(m_table.cell(row, 0));
+    for (size_t col = 1; col < m_table.cols; col++) {
+      a_z.push_back(m_table.cell(row, col));
     }
   }
   return true;
 }
 
+std::uint64_t import_points_t::get_series_id()
+{
+  switch (m_selected) {
+    case import_points_dialog_t::select_t::rows: {
+      return get_series_id(m_selected, m_selected_row);
+    }
+    case import_points_dialog_t::select_t::cols: {
+      return get_series_id(m_selected, m_selected_col);
+    }
+    default: {
+    } break;
+  }
+  return 0;
+}
+
+std::uint64_t import_points_t::get_series_id(import_points_dialog_t::select_t a_select, int a_index)
+{
+  if (a_select == import_points_dialog_t::select_t::none) {
+    return 0;
+  }
+  //    ,        
+  std::uint64_t select_bit = (a_select == import_points_dialog_t::select_t::cols) ? 1 : 0;
+  return (static_cast<std::uint64_t>(m_table_version) << 32) | (select_bit << 31) |
+    static_cast<std::uint64_t>(a_index);
+}
+
+bool import_points_t::are_correct_points_valid(const std::vector<double> &a_correct_points, const std::vector<double> &a_x)
+{
+  if (a_correct_points.size() < 2) {
+    return false;
+  }
+  return m_knots.assign(a_x, a_correct_points);
+}
+
 void import_points_t::fill_data_arrays(std::vector<double> a_correct_points)
 {
   std::vector<double> x;
   std::vector<double> y;
-  fill_x_y_arrays(x, y);
+  switch (m_selected) {
+    case import_points_dialog_t::select_t::rows: {
+      fill_x_y_arrays(m_selected, m_selected_row, x, y);
+    } break;
+    case import_points_dialog_t::select_t::cols: {
+      fill_x_y_arrays(m_selected, m_selected_col, x, y);
+    } break;
+    default: {
+    } break;
+  }
+  //  ,     
+  normalize_points(x, y);
 
   if (are_correct_points_valid(a_correct_points, x)) {
     m_correct_points = std::move(a_correct_points);
-  } else {
+    std::sort(m_correct_points.begin(), m_correct_points.end());
+    m_correct_points.erase(std::unique(m_correct_points.begin(), m_correct_points.end()),
+      m_correct_points.end());
+  } else if (!x.empty()) {
     m_correct_points = { x.front(), x.back() };
   }
+  //  (  )  ,   update_points
   emit points_are_ready(x, y);
 }
 
+bool import_points_t::get_next_position(move_direction_t a_direction,
+  import_points_dialog_t::select_t &a_select, int &a_index)
+{
+  if (m_selected == import_points_dialog_t::select_t::none) {
+    return false;
+  }
+  switch (a_direction) {
+    case move_direction_t::up: {
+      a_select = import_points_dialog_t::select_t::rows;
+      a_index = m_selected_row > 1 ? m_selected_row - 1 : m_selected_row;
+    } break;
+    case move_direction_t::down: {
+      a_select = import_points_dialog_t::select_t::rows;
+      a_index = m_selected_row < m_csv_model->rowCount() - 1 ? m_selected_row + 1 : m_selected_row;
+    } break;
+    case move_direction_t::right: {
+      a_select = import_points_dialog_t::select_t::cols;
+      a_index = m_selected_col < m_csv_model->columnCount() - 1 ? m_selected_col + 1 : m_selected_col;
+    } break;
+    case move_direction_t::left: {
+      a_select = import_points_dialog_t::select_t::cols;
+      a_index = m_selected_col > 1 ? m_selected_col - 1 : m_selected_col;
+    } break;
+  }
+  return true;
+}
+
 void import_points_t::set_next_data(move_direction_t a_direction)
 {
-  if (m_selected != import_points_dialog_t::select_t::none) {
-    switch (a_direction) {
-      case move_direction_t::up: {
-        m_selected = import_points_dialog_t::select_t::rows;
-        if (m_selected_row > 1) {
-          m_selected_row--;
-        }
-      } break;
-      case move_direction_t::down: {
-        m_selected = import_points_dialog_t::select_t::rows;
-        if (m_selected_row < m_csv_model->rowCount() - 1) {
-          m_selected_row++;
-        }
-      } break;
-      case move_direction_t::right: {
-        m_selected = import_points_dialog_t::select_t::cols;
-        if (m_selected_col < m_csv_model->columnCount() - 1) {
-          m_selected_col++;
-        }
-      } break;
-      case move_direction_t::left: {
-        m_selected = import_points_dialog_t::select_t::cols;
-        if (m_selected_col > 1) {
-          m_selected_col--;
-        }
-      } break;
+  import_points_dialog_t::select_t select = m_selected;
+  int index = 0;
+  if (get_next_position(a_direction, select, index)) {
+    m_selected = select;
+    if (select == import_points_dialog_t::select_t::rows) {
+      m_selected_row = index;
+    } else {
+      m_selected_col = index;
     }
     fill_data_arrays(m_correct_points);
   }
@@ -145,6 +250,22 @@ import_points_dialog_t::select_t import_points_t::get_select_type()
   return m_selected;
 }
 
+double import_points_t::get_x_value()
+{
+  parse_table();
+  switch (m_selected) {
+    case import_points_dialog_t::select_t::rows: {
+      return m_table.cell(static_cast<size_t>(m_selected_row), 0);
+    }
+    case import_points_dialog_t::select_t::cols: {
+      return m_table.cell(0, static_cast<size_t>(m_selected_col));
+    }
+    default: {
+    } break;
+  }
+  return std::numeric_limits<double>::quiet_NaN();
+}
+
 QString import_points_t::get_x()
 {
   QString current_x_str = "";
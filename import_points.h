@@ -3,7 +3,10 @@
 
 #include <QObject>
 #include <QWidget>
+#include <cstdint>
 #include "import_points_dialog.h"
+#include "knot_subset.h"
+#include "table_reader.h"
 
 class import_points_t : public QObject
 {
@@ -16,8 +19,25 @@ public:
   void create_import_points_dialog(QWidget *a_parent);
   bool are_correct_points_valid(const std::vector<double> &a_correct_points, const std::vector<double> &a_x);
   void set_next_data(move_direction_t a_direction);
+  //Where set_next_data would move, without moving
+  bool get_next_position(move_direction_t a_direction, import_points_dialog_t::select_t &a_select,
+    int &a_index);
   import_points_dialog_t::select_t get_select_type();
   QString get_x();
+  //X of the selected series as a number, NaN if nothing is selected
+  double get_x_value();
+
+  //Identifies a row/column of the currently loaded table, 0 if nothing is selected
+  std::uint64_t get_series_id();
+  std::uint64_t get_series_id(import_points_dialog_t::select_t a_select, int a_index);
+  void fill_x_y_arrays(import_points_dialog_t::select_t a_select, int a_index,
+    std::vector<double> &a_x, std::vector<double> &a_y);
+  //Whole table for surface_interp_t: a_x is the first row, a_y is the first
+  //column, a_z holds the remaining rows one after another
+  bool fill_grid_arrays(std::vector<double> &a_x, std::vector<double> &a_y,
+    std::vector<double> &a_z);
+  //Numeric copy of the loaded table for fit_table
+  const table_t& get_table();
 
 signals:
   void points_are_ready(std::vector<double> &a_x, std::vector<double> &a_y);
@@ -27,6 +47,7 @@ private slots:
   void set_new_row(int a_row);
   void set_new_col(int a_col);
   void fill_data_arrays(std::vector<double> a_correct_points);
+  void invalidate_table();
 
 private:
   QString m_last_file_name;
@@ -39,7 +60,15 @@ private:
   int m_selected_row;
   int m_selected_col;
 
-  void fill_x_y_arrays(std::vector<double> &a_x, std::vector<double> &a_y);
+  //Numeric copy of m_csv_model, so that the strings are parsed once per table
+  table_t m_table;
+  bool m_table_valid;
+  std::size_t m_table_version;
+
+  //Reused by are_correct_points_valid
+  knot_subset_t m_knots;
+
+  void parse_table();
 };
 
 #endif // IMPORT_POINTS_H
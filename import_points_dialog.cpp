@@ -1,5 +1,6 @@
 #include "import_points_dialog.h"
 #include "ui_import_points_form.h"
+#include "instrumentation.h"
 
 #include <QDebug>
 #include <QFileDialog>
@@ -90,6 +91,8 @@ void import_points_dialog_t::vhSelected(int a_row)
 
 void import_points_dialog_t::insert_points_to_table(QFile* a_file)
 {
+  SPLINES_SCOPED_TIMER(itm_csv_import);
+  SPLINES_COUNT_N(ic_csv_bytes, static_cast<std::uint64_t>(a_file->size()));
   m_csv_model->clear();
   m_data_format_error = false;
 
@@ -101,6 +104,7 @@ void import_points_dialog_t::insert_points_to_table(QFile* a_file)
   while (!file_sream.atEnd())
   {
     auto values = file_sream.readLine().split(";");
+    SPLINES_COUNT(ic_csv_rows);
     if (values.size() != columns_count) {
       m_data_format_error = true;
     }
@@ -0,0 +1,186 @@
+#include "input_normalization.h"
+#include "parallel_for.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <numeric>
+
+namespace {
+
+//Below this size radix passes cost more than a comparison sort
+constexpr std::size_t radix_sort_min_size = 1 << 15;
+//Each thread gets at least this many points
+constexpr std::size_t min_points_per_thread = 1 << 18;
+
+constexpr unsigned radix_bits = 11;
+constexpr std::size_t radix_size = std::size_t(1) << radix_bits;
+constexpr unsigned radix_pass_count = (64 + radix_bits - 1) / radix_bits;
+
+//Unsigned key with the same order as the double
+std::uint64_t sortable_key(double a_value)
+{
+  std::uint64_t bits = 0;
+  std::memcpy(&bits, &a_value, sizeof(bits));
+  const std::uint64_t sign = std::uint64_t(1) << 63;
+  return (bits & sign) ? ~bits : (bits | sign);
+}
+
+std::size_t digit(std::uint64_t a_key, unsigned a_pass)
+{
+  return static_cast<std::size_t>(a_key >> (a_pass * radix_bits)) & (radix_size - 1);
+}
+
+//Permutation that sorts a_keys, stable
+std::vector<std::uint32_t> radix_sort_order(const std::vector<double>& a_keys)
+{
+  const std::size_t n = a_keys.size();
+  const std::size_t thread_count = parallel_thread_count(n, min_points_per_thread);
+
+  std::vector<std::uint64_t> keys(n);
+  std::vector<std::uint32_t> order(n);
+  std::vector<std::uint64_t> keys_tmp(n);
+  std::vector<std::uint32_t> order_tmp(n);
+  for_each_chunk(n, thread_count, [&](std::size_t, std::size_t a_begin, std::size_t a_end) {
+    for (std::size_t i = a_begin; i < a_end; i++) {
+      keys[i] = sortable_key(a_keys[i]);
+      order[i] = static_cast<std::uint32_t>(i);
+    }
+  });
+
+  //counts[t * radix_size + d] - number of digits d in the chunk of thread t,
+  //turned into the output position of the first of them
+  std::vector<std::size_t> counts(thread_count * radix_size);
+  for (unsigned pass = 0; pass < radix_pass_count; pass++) {
+    std::fill(counts.begin(), counts.end(), 0);
+    for_each_chunk(n, thread_count, [&](std::size_t a_thread, std::size_t a_begin, std::size_t a_end) {
+      std::size_t* count = counts.data() + a_thread * radix_size;
+      for (std::size_t i = a_begin; i < a_end; i++) {
+        count[digit(keys[i], pass)]++;
+      }
+    });
+
+    //Digits are equal in all keys, the pass would not move anything
+    bool skip = false;
+    std::size_t position = 0;
+    for (std::size_t d = 0; d < radix_size; d++) {
+      std::size_t digit_total = 0;
+      for (std::size_t t = 0; t < thread_count; t++) {
+        std::size_t count = counts[t * radix_size + d];
+        counts[t * radix_size + d] = position;
+        position += count;
+        digit_total += count;
+      }
+      if (digit_total == n) {
+        skip = true;
+      }
+    }
+    if (skip) {
+      continue;
+    }
+
+    for_each_chunk(n, thread_count, [&](std::size_t a_thread, std::size_t a_begin, std::size_t a_end) {
+      std::size_t* offset = counts.data() + a_thread * radix_size;
+      for (std::size_t i = a_begin; i < a_end; i++) {
+        std::size_t target = offset[digit(keys[i], pass)]++;
+        keys_tmp[target] = keys[i];
+        order_tmp[target] = order[i];
+      }
+    });
+    keys.swap(keys_tmp);
+    order.swap(order_tmp);
+  }
+  return order;
+}
+
+} // namespace
+
+void sort_by_key(std::vector<double>& a_keys, std::vector<double>& a_values)
+{
+  assert(a_keys.size() == a_values.size());
+  const std::size_t n = a_keys.size();
+  if (std::is_sorted(a_keys.begin(), a_keys.end())) {
+    return;
+  }
+
+  std::vector<std::uint32_t> order;
+  if ((n >= radix_sort_min_size) && (n <= std::numeric_limits<std::uint32_t>::max())) {
+    order = radix_sort_order(a_keys);
+  } else {
+    order.resize(n);
+    std::iota(order.begin(), order.end(), std::uint32_t(0));
+    std::stable_sort(order.begin(), order.end(),
+      [&a_keys](std::uint32_t a_left, std::uint32_t a_right) {
+        return a_keys[a_left] < a_keys[a_right];
+      });
+  }
+
+  std::vector<double> keys(n);
+  std::vector<double> values(n);
+  for (std::size_t i = 0; i < n; i++) {
+    keys[i] = a_keys[order[i]];
+    values[i] = a_values[order[i]];
+  }
+  a_keys.swap(keys);
+  a_values.swap(values);
+}
+
+void normalize_points(std::vector<double>& a_x, std::vector<double>& a_y,
+  duplicate_policy_t a_policy)
+{
+  assert(a_x.size() == a_y.size());
+  std::size_t n = std::min(a_x.size(), a_y.size());
+
+  bool is_normal = true;
+  for (std::size_t i = 0; (i < n) && is_normal; i++) {
+    is_normal = !std::isnan(a_x[i]) && !std::isnan(a_y[i]) && ((i == 0) || (a_x[i - 1] < a_x[i]));
+  }
+  if (is_normal) {
+    a_x.resize(n);
+    a_y.resize(n);
+    return;
+  }
+
+  std::size_t count = 0;
+  for (std::size_t i = 0; i < n; i++) {
+    if (!std::isnan(a_x[i]) && !std::isnan(a_y[i])) {
+      a_x[count] = a_x[i];
+      a_y[count] = a_y[i];
+      count++;
+    }
+  }
+  a_x.resize(count);
+  a_y.resize(count);
+
+  sort_by_key(a_x, a_y);
+
+  std::size_t out = 0;
+  for (std::size_t begin = 0; begin < count;) {
+    std::size_t end = begin + 1;
+    double sum = a_y[begin];
+    while ((end < count) && (a_x[end] == a_x[begin])) {
+      sum += a_y[end];
+      end++;
+    }
+    double y = a_y[begin];
+    switch (a_policy) {
+      case duplicate_policy_t::mean: {
+        y = sum / static_cast<double>(end - begin);
+      } break;
+      case duplicate_policy_t::first: {
+      } break;
+      case duplicate_policy_t::last: {
+        y = a_y[end - 1];
+      } break;
+    }
+    a_x[out] = a_x[begin];
+    a_y[out] = y;
+    out++;
+    begin = end;
+  }
+  a_x.resize(out);
+  a_y.resize(out);
+}
@@ -0,0 +1,24 @@
+#ifndef INPUT_NORMALIZATION_H
+#define INPUT_NORMALIZATION_H
+
+#include <vector>
+
+//What to keep when several points have the same x
+enum class duplicate_policy_t {
+  mean,
+  first,
+  last
+};
+
+//Prepares arbitrary points for set_points: drops points with NaN in x or y,
+//sorts by x and merges points with equal x. The sort is stable, so first/last
+//refer to the input order. Already strictly increasing input is only checked.
+//The arrays must be the same size, they are shrunk to the result size
+void normalize_points(std::vector<double>& a_x, std::vector<double>& a_y,
+  duplicate_policy_t a_policy = duplicate_policy_t::mean);
+
+//Stable sort of both arrays by a_keys. Large inputs use a parallel
+//LSD radix sort over the bit patterns of the keys, NaN must be removed before
+void sort_by_key(std::vector<double>& a_keys, std::vector<double>& a_values);
+
+#endif // INPUT_NORMALIZATION_H
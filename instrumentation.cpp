@@ -0,0 +1,156 @@
+#include "instrumentation.h"
+
+std::atomic<std::uint64_t> g_instr_counters[ic_count];
+
+namespace {
+
+std::atomic<std::uint64_t> g_timer_calls[itm_count];
+std::atomic<std::uint64_t> g_timer_total_ns[itm_count];
+std::atomic<std::uint64_t> g_timer_max_ns[itm_count];
+std::atomic<instr_sample_hook_t> g_sample_hook(nullptr);
+
+} // namespace
+
+const char* instr_counter_name(instr_counter_t a_counter)
+{
+  switch (a_counter) {
+    case ic_fits: return "fits";
+    case ic_evaluations: return "evaluations";
+    case ic_left_extrapolations: return "left_extrapolations";
+    case ic_right_extrapolations: return "right_extrapolations";
+    case ic_hinted_searches: return "hinted_searches";
+    case ic_binary_searches: return "binary_searches";
+    case ic_allocations: return "allocations";
+    case ic_allocated_bytes: return "allocated_bytes";
+    case ic_rendered_points: return "rendered_points";
+    case ic_csv_bytes: return "csv_bytes";
+    case ic_csv_rows: return "csv_rows";
+    case ic_count: break;
+  }
+  return "";
+}
+
+const char* instr_timer_name(instr_timer_t a_timer)
+{
+  switch (a_timer) {
+    case itm_set_points: return "set_points";
+    case itm_fit_job: return "fit_job";
+    case itm_interp_fit: return "interp_fit";
+    case itm_interp_sampling: return "interp_sampling";
+    case itm_draw_lines: return "draw_lines";
+    case itm_redraw: return "redraw";
+    case itm_csv_import: return "csv_import";
+    case itm_count: break;
+  }
+  return "";
+}
+
+instr_snapshot_t instr_snapshot()
+{
+  instr_snapshot_t snapshot;
+  for (size_t i = 0; i < ic_count; i++) {
+    snapshot.counters[i] = g_instr_counters[i].load(std::memory_order_relaxed);
+  }
+  for (size_t i = 0; i < itm_count; i++) {
+    snapshot.timer_calls[i] = g_timer_calls[i].load(std::memory_order_relaxed);
+    snapshot.timer_total_ns[i] = g_timer_total_ns[i].load(std::memory_order_relaxed);
+    snapshot.timer_max_ns[i] = g_timer_max_ns[i].load(std::memory_order_relaxed);
+  }
+  return snapshot;
+}
+
+void instr_reset()
+{
+  for (auto& counter: g_instr_counters) {
+    counter.store(0, std::memory_order_relaxed);
+  }
+  for (size_t i = 0; i < itm_count; i++) {
+    g_timer_calls[i].store(0, std::memory_order_relaxed);
+    g_timer_total_ns[i].store(0, std::memory_order_relaxed);
+    g_timer_max_ns[i].store(0, std::memory_order_relaxed);
+  }
+}
+
+void instr_add_time(instr_timer_t a_timer, std::uint64_t a_ns, unsigned a_tag)
+{
+  g_timer_calls[a_timer].fetch_add(1, std::memory_order_relaxed);
+  g_timer_total_ns[a_timer].fetch_add(a_ns, std::memory_order_relaxed);
+  std::uint64_t max_ns = g_timer_max_ns[a_timer].load(std::memory_order_relaxed);
+  while ((a_ns > max_ns) &&
+    !g_timer_max_ns[a_timer].compare_exchange_weak(max_ns, a_ns, std::memory_order_relaxed)) {
+  }
+  instr_sample_hook_t hook = g_sample_hook.load(std::memory_order_acquire);
+  if (hook) {
+    hook(a_timer, a_tag, a_ns);
+  }
+}
+
+void instr_set_sample_hook(instr_sample_hook_t a_hook)
+{
+  g_sample_hook.store(a_hook, std::memory_order_release);
+}
+
+std::string instr_to_json(const instr_snapshot_t& a_snapshot)
+{
+  std::string json = "{\"enabled\":";
+  json += instr_enabled() ? "true" : "false";
+  json += ",\"counters\":{";
+  for (size_t i = 0; i < ic_count; i++) {
+    if (i != 0) {
+      json += ",";
+    }
+    json += "\"";
+    json += instr_counter_name(static_cast<instr_counter_t>(i));
+    json += "\":" + std::to_string(a_snapshot.counters[i]);
+  }
+  json += "},\"timers\":{";
+  for (size_t i = 0; i < itm_count; i++) {
+    if (i != 0) {
+      json += ",";
+    }
+    json += "\"";
+    json += instr_timer_name(static_cast<instr_timer_t>(i));
+    json += "\":{\"calls\":" + std::to_string(a_snapshot.timer_calls[i]) +
+      ",\"total_ns\":" + std::to_string(a_snapshot.timer_total_ns[i]) +
+      ",\"max_ns\":" + std::to_string(a_snapshot.timer_max_ns[i]) + "}";
+  }
+  json += "}}";
+  return json;
+}
+
+void instr_visit(const instr_snapshot_t& a_snapshot,
+  const std::function<void(const char*, std::uint64_t)>& a_fn)
+{
+  for (size_t i = 0; i < ic_count; i++) {
+    a_fn(instr_counter_name(static_cast<instr_counter_t>(i)), a_snapshot.counters[i]);
+  }
+  for (size_t i = 0; i < itm_count; i++) {
+    std::string name = instr_timer_name(static_cast<instr_timer_t>(i));
+    a_fn((name + ".calls").c_str(), a_snapshot.timer_calls[i]);
+    a_fn((name + ".total_ns").c_str(), a_snapshot.timer_total_ns[i]);
+    a_fn((name + ".max_ns").c_str(), a_snapshot.timer_max_ns[i]);
+  }
+}
+
+instr_counting_resource_t::instr_counting_resource_t(std::pmr::memory_resource* ap_upstream):
+  mp_upstream(ap_upstream)
+{
+}
+
+void* instr_counting_resource_t::do_allocate(std::size_t a_bytes, std::size_t a_alignment)
+{
+  SPLINES_COUNT(ic_allocations);
+  SPLINES_COUNT_N(ic_allocated_bytes, a_bytes);
+  return mp_upstream->allocate(a_bytes, a_alignment);
+}
+
+void instr_counting_resource_t::do_deallocate(void* ap_pointer, std::size_t a_bytes,
+  std::size_t a_alignment)
+{
+  mp_upstream->deallocate(ap_pointer, a_bytes, a_alignment);
+}
+
+bool instr_counting_resource_t::do_is_equal(const std::pmr::memory_resource& a_other) const noexcept
+{
+  return this == &a_other;
+}
@@ -0,0 +1,145 @@
+#ifndef INSTRUMENTATION_H
+#define INSTRUMENTATION_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory_resource>
+#include <string>
+
+//Counters and timers of the hot paths. The SPLINES_* macros compile to
+//nothing unless SPLINES_INSTRUMENTATION is defined (see the .pro file),
+//the export functions below always exist and report zeros then
+
+enum instr_counter_t {
+  ic_fits = 0,
+  ic_evaluations,
+  ic_left_extrapolations,
+  ic_right_extrapolations,
+  //Segment searches answered by the hint and by a binary search
+  ic_hinted_searches,
+  ic_binary_searches,
+  //Allocations through instr_counting_resource_t
+  ic_allocations,
+  ic_allocated_bytes,
+  //Chart points passed to the line series
+  ic_rendered_points,
+  ic_csv_bytes,
+  ic_csv_rows,
+  ic_count
+};
+
+enum instr_timer_t {
+  itm_set_points = 0,
+  itm_fit_job,
+  //Fit and sampling of one interpolation inside a fit job,
+  //tagged with interpolation_type_t
+  itm_interp_fit,
+  itm_interp_sampling,
+  itm_draw_lines,
+  //Whole update of the window after a fit result arrived
+  itm_redraw,
+  itm_csv_import,
+  itm_count
+};
+
+//Called for every finished timer scope from the thread that ran it,
+//so it must be cheap and thread safe
+typedef void (*instr_sample_hook_t)(instr_timer_t a_timer, unsigned a_tag,
+  std::uint64_t a_ns);
+
+struct instr_snapshot_t
+{
+  std::uint64_t counters[ic_count];
+  std::uint64_t timer_calls[itm_count];
+  std::uint64_t timer_total_ns[itm_count];
+  std::uint64_t timer_max_ns[itm_count];
+};
+
+extern std::atomic<std::uint64_t> g_instr_counters[ic_count];
+
+const char* instr_counter_name(instr_counter_t a_counter);
+const char* instr_timer_name(instr_timer_t a_timer);
+constexpr bool instr_enabled()
+{
+#ifdef SPLINES_INSTRUMENTATION
+  return true;
+#else
+  return false;
+#endif
+}
+
+instr_snapshot_t instr_snapshot();
+void instr_reset();
+void instr_add_time(instr_timer_t a_timer, std::uint64_t a_ns, unsigned a_tag = 0);
+//Pass nullptr to remove the hook
+void instr_set_sample_hook(instr_sample_hook_t a_hook);
+//{"counters":{"fits":1,...},"timers":{"set_points":{"calls":1,"total_ns":2,"max_ns":2},...}}
+std::string instr_to_json(const instr_snapshot_t& a_snapshot);
+//a_fn(name, value) for every counter and "<timer>.calls", "<timer>.total_ns", "<timer>.max_ns"
+void instr_visit(const instr_snapshot_t& a_snapshot,
+  const std::function<void(const char*, std::uint64_t)>& a_fn);
+
+inline void instr_add(instr_counter_t a_counter, std::uint64_t a_value)
+{
+  g_instr_counters[a_counter].fetch_add(a_value, std::memory_order_relaxed);
+}
+
+class instr_scoped_timer_t
+{
+public:
+  explicit instr_scoped_timer_t(instr_timer_t a_timer, unsigned a_tag = 0):
+    m_timer(a_timer),
+    m_tag(a_tag),
+    m_start(std::chrono::steady_clock::now())
+  {
+  }
+  ~instr_scoped_timer_t()
+  {
+    auto elapsed = std::chrono::steady_clock::now() - m_start;
+    instr_add_time(m_timer, static_cast<std::uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()), m_tag);
+  }
+  instr_scoped_timer_t(const instr_scoped_timer_t&) = delete;
+  instr_scoped_timer_t& operator=(const instr_scoped_timer_t&) = delete;
+private:
+  instr_timer_t m_timer;
+  unsigned m_tag;
+  std::chrono::steady_clock::time_point m_start;
+};
+
+//Pass-through memory resource that counts allocations,
+//for the interpolators constructed with a memory resource
+class instr_counting_resource_t : public std::pmr::memory_resource
+{
+public:
+  explicit instr_counting_resource_t(std::pmr::memory_resource* ap_upstream =
+    std::pmr::get_default_resource());
+private:
+  std::pmr::memory_resource* mp_upstream;
+
+  void* do_allocate(std::size_t a_bytes, std::size_t a_alignment) override;
+  void do_deallocate(void* ap_pointer, std::size_t a_bytes, std::size_t a_alignment) override;
+  bool do_is_equal(const std::pmr::memory_resource& a_other) const noexcept override;
+};
+
+#define SPLINES_INSTR_CONCAT_IMPL(A, B) A##B
+#define SPLINES_INSTR_CONCAT(A, B) SPLINES_INSTR_CONCAT_IMPL(A, B)
+
+#ifdef SPLINES_INSTRUMENTATION
+#define SPLINES_COUNT(COUNTER) instr_add(COUNTER, 1)
+#define SPLINES_COUNT_N(COUNTER, N) instr_add(COUNTER, N)
+#define SPLINES_SCOPED_TIMER(TIMER) \
+  instr_scoped_timer_t SPLINES_INSTR_CONCAT(instr_timer_, __LINE__)(TIMER)
+#define SPLINES_SCOPED_TIMER_TAG(TIMER, TAG) \
+  instr_scoped_timer_t SPLINES_INSTR_CONCAT(instr_timer_, __LINE__)(TIMER, TAG)
+#else
+#define SPLINES_COUNT(COUNTER) ((void)0)
+#define SPLINES_COUNT_N(COUNTER, N) ((void)0)
+#define SPLINES_SCOPED_TIMER(TIMER) ((void)0)
+#define SPLINES_SCOPED_TIMER_TAG(TIMER, TAG) ((void)0)
+#endif // SPLINES_INSTRUMENTATION
+
+#endif // INSTRUMENTATION_H
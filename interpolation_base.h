@@ -1,7 +1,18 @@
 #ifndef INTERPOLATION_BASE_H
 #define INTERPOLATION_BASE_H
 
+#include "input_normalization.h"
+
 #include <cstdlib>
+#include <vector>
+
+//Value and the first two derivatives in one point
+struct interpolation_derivs_t
+{
+  double value;
+  double first;
+  double second;
+};
 
 class interpolation_base_t
 {
@@ -9,6 +20,35 @@ public:
   virtual ~interpolation_base_t() {}
   virtual void set_points(const double* a_x, const double* a_y, size_t a_length) = 0;
   virtual double operator()(double a_x) = 0;
+  //Same as set_points for unsorted input with duplicates and NaN,
+  //at least two distinct points must remain after normalize_points
+  void set_unordered_points(const double* a_x, const double* a_y, size_t a_length,
+    duplicate_policy_t a_policy = duplicate_policy_t::mean)
+  {
+    std::vector<double> x(a_x, a_x + a_length);
+    std::vector<double> y(a_y, a_y + a_length);
+    normalize_points(x, y, a_policy);
+    set_points(x.data(), y.data(), x.size());
+  }
+  //One segment search for all three values
+  virtual interpolation_derivs_t calc_derivs(double a_x) = 0;
+  virtual void calc_derivs_array(const double* a_x, double* a_value, double* a_first,
+    double* a_second, size_t a_count)
+  {
+    for (size_t i = 0; i < a_count; i++) {
+      interpolation_derivs_t derivs = calc_derivs(a_x[i]);
+      a_value[i] = derivs.value;
+      a_first[i] = derivs.first;
+      a_second[i] = derivs.second;
+    }
+  }
+  //Batch evaluation, sorted a_x are the fast case
+  virtual void calc_array(const double* a_x, double* a_y, size_t a_count)
+  {
+    for (size_t i = 0; i < a_count; i++) {
+      a_y[i] = operator()(a_x[i]);
+    }
+  }
 };
 
 
@@ -0,0 +1,46 @@
+#include "interpolation_factory.h"
+
+#include "spline.h"
+#include "hermit.h"
+#include "akima.h"
+#include "linear_interpolation.hpp"
+
+std::unique_ptr<interpolation_base_t> make_interpolation(interpolation_type_t a_type)
+{
+  switch (a_type) {
+    case it_cubic: {
+      return std::unique_ptr<interpolation_base_t>(new tk::spline());
+    }
+    case it_hermite: {
+      return std::unique_ptr<interpolation_base_t>(new pchip_t<double>());
+    }
+    case it_linear: {
+      return std::unique_ptr<interpolation_base_t>(new irs::line_interp_t<double>());
+    }
+    case it_akima: {
+      return std::unique_ptr<interpolation_base_t>(
+        new akima_t<double>(akima_t<double>::kind_t::original));
+    }
+    case it_makima: {
+      return std::unique_ptr<interpolation_base_t>(
+        new akima_t<double>(akima_t<double>::kind_t::modified));
+    }
+    case it_count: {
+    } break;
+  }
+  assert(false);
+  return nullptr;
+}
+
+const char* interpolation_name(interpolation_type_t a_type)
+{
+  switch (a_type) {
+    case it_cubic: return "Cubic";
+    case it_hermite: return "Hermite";
+    case it_linear: return "Linear";
+    case it_akima: return "Akima";
+    case it_makima: return "Makima";
+    case it_count: break;
+  }
+  return "";
+}
@@ -0,0 +1,21 @@
+#ifndef INTERPOLATION_FACTORY_H
+#define INTERPOLATION_FACTORY_H
+
+#include "interpolation_base.h"
+
+#include <memory>
+
+enum interpolation_type_t {
+  it_cubic = 0,
+  it_hermite = 1,
+  it_linear = 2,
+  it_akima = 3,
+  it_makima = 4,
+  it_count = 5
+};
+
+//Each call returns a fresh object, so that every thread can fit its own copy
+std::unique_ptr<interpolation_base_t> make_interpolation(interpolation_type_t a_type);
+const char* interpolation_name(interpolation_type_t a_type);
+
+#endif // INTERPOLATION_FACTORY_H
@@ -0,0 +1,158 @@
+#ifndef INVERSE_SEARCH_H
+#define INVERSE_SEARCH_H
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <memory_resource>
+#include <vector>
+
+//Splits the knot values into runs of monotone segments, so that the segment
+//where f(x) = y can be found by a binary search inside each run.
+//Calibration curves are monotone, then there is only one run
+template <class T>
+class monotone_index_t
+{
+public:
+  explicit monotone_index_t(std::pmr::memory_resource* a_resource =
+    std::pmr::get_default_resource());
+  template <class A>
+  void build(const std::vector<T, A>& a_knot_y);
+  //First segment i (smallest x) with a_y between knot y[i] and y[i+1]
+  template <class A>
+  bool find(const std::vector<T, A>& a_knot_y, T a_y, std::size_t& a_segment) const;
+
+private:
+  struct run_t
+  {
+    //Segments [begin, end), knots begin..end
+    std::size_t begin;
+    std::size_t end;
+    bool increasing;
+  };
+  std::pmr::vector<run_t> m_runs;
+};
+
+template <class T>
+monotone_index_t<T>::monotone_index_t(std::pmr::memory_resource* a_resource):
+  m_runs(a_resource)
+{
+}
+
+template <class T>
+template <class A>
+void monotone_index_t<T>::build(const std::vector<T, A>& a_knot_y)
+{
+  m_runs.clear();
+  const std::size_t segments_count = a_knot_y.size() - 1;
+  std::size_t begin = 0;
+  while (begin < segments_count) {
+    //Flat segments join any run
+    std::size_t end = begin;
+    int direction = 0;
+    while (end < segments_count) {
+      T delta = a_knot_y[end + 1] - a_knot_y[end];
+      int sign = (delta > 0) ? 1 : ((delta < 0) ? -1 : 0);
+      if (direction != 0 && sign != 0 && sign != direction) {
+        break;
+      }
+      if (direction == 0) {
+        direction = sign;
+      }
+      end++;
+    }
+    run_t run;
+    run.begin = begin;
+    run.end = end;
+    run.increasing = direction >= 0;
+    m_runs.push_back(run);
+    begin = end;
+  }
+}
+
+template <class T>
+template <class A>
+bool monotone_index_t<T>::find(const std::vector<T, A>& a_knot_y, T a_y,
+  std::size_t& a_segment) const
+{
+  for (const run_t& run: m_runs) {
+    const T first = a_knot_y[run.begin];
+    const T last = a_knot_y[run.end];
+    if (run.increasing) {
+      if (a_y < first || a_y > last) {
+        continue;
+      }
+      //First knot after begin with y >= a_y closes the segment
+      auto it = std::lower_bound(a_knot_y.begin() + run.begin + 1,
+        a_knot_y.begin() + run.end + 1, a_y);
+      a_segment = static_cast<std::size_t>(it - a_knot_y.begin()) - 1;
+    } else {
+      if (a_y > first || a_y < last) {
+        continue;
+      }
+      auto it = std::lower_bound(a_knot_y.begin() + run.begin + 1,
+        a_knot_y.begin() + run.end + 1, a_y, [](T a_knot, T a_value) {
+          return a_knot > a_value;
+        });
+      a_segment = static_cast<std::size_t>(it - a_knot_y.begin()) - 1;
+    }
+    return true;
+  }
+  return false;
+}
+
+//Solves y0 + h*(c1 + h*(c2 + h*c3)) = a_target for h in [0, a_width],
+//the polynomial values at both ends must bracket a_target.
+//Newton steps are used while they stay inside the bracket, bisection otherwise
+template <class T>
+T solve_segment_cubic(T a_y0, T a_c1, T a_c2, T a_c3, T a_width, T a_target)
+{
+  auto poly = [&](T h) {
+    return a_y0 + h * (a_c1 + h * (a_c2 + h * a_c3)) - a_target;
+  };
+  T lo = 0;
+  T hi = a_width;
+  T f_lo = poly(lo);
+  T f_hi = poly(hi);
+  if (f_lo == 0) {
+    return lo;
+  }
+  if (f_hi == 0) {
+    return hi;
+  }
+  if ((f_lo > 0) == (f_hi > 0)) {
+    //Rounding at the knots, the nearest end is the answer
+    return std::fabs(f_lo) < std::fabs(f_hi) ? lo : hi;
+  }
+
+  T h = lo + (hi - lo) * f_lo / (f_lo - f_hi);
+  const T tolerance = std::fabs(a_width) * 4 * std::numeric_limits<T>::epsilon();
+  for (int iteration = 0; iteration < 64; iteration++) {
+    T f = poly(h);
+    if (f == 0) {
+      return h;
+    }
+    if ((f > 0) == (f_lo > 0)) {
+      lo = h;
+      f_lo = f;
+    } else {
+      hi = h;
+    }
+    if (hi - lo <= tolerance) {
+      break;
+    }
+    T derivative = a_c1 + h * (2 * a_c2 + h * 3 * a_c3);
+    T next = (derivative != 0) ? h - f / derivative : lo;
+    if (!(next > lo && next < hi)) {
+      next = (lo + hi) / 2;
+    } else if (std::fabs(next - h) <= tolerance) {
+      return next;
+    }
+    h = next;
+  }
+  return h;
+}
+
+#endif // INVERSE_SEARCH_H
@@ -0,0 +1,90 @@
+#include "knot_subset.h"
+
+#include <algorithm>
+#include <cassert>
+
+knot_subset_t::knot_subset_t():
+  m_indices(),
+  m_sorted_values()
+{
+}
+
+bool knot_subset_t::assign(const std::vector<double>& a_x, const std::vector<double>& a_values)
+{
+  const std::vector<double>* values = &a_values;
+  if (!std::is_sorted(a_values.begin(), a_values.end())) {
+    m_sorted_values.assign(a_values.begin(), a_values.end());
+    std::sort(m_sorted_values.begin(), m_sorted_values.end());
+    values = &m_sorted_values;
+  }
+
+  m_indices.clear();
+  bool all_found = true;
+  std::size_t x_index = 0;
+  for (std::size_t i = 0; i < values->size(); i++) {
+    const double value = (*values)[i];
+    if ((i > 0) && (value == (*values)[i - 1])) {
+      continue;
+    }
+    while ((x_index < a_x.size()) && (a_x[x_index] < value)) {
+      x_index++;
+    }
+    if ((x_index < a_x.size()) && (a_x[x_index] == value)) {
+      m_indices.push_back(x_index);
+      x_index++;
+    } else {
+      all_found = false;
+    }
+  }
+  return all_found;
+}
+
+void knot_subset_t::assign_ends(std::size_t a_count)
+{
+  m_indices.clear();
+  if (a_count > 0) {
+    m_indices.push_back(0);
+  }
+  if (a_count > 1) {
+    m_indices.push_back(a_count - 1);
+  }
+}
+
+void knot_subset_t::clear()
+{
+  m_indices.clear();
+}
+
+const std::vector<std::size_t>& knot_subset_t::indices() const
+{
+  return m_indices;
+}
+
+std::size_t knot_subset_t::size() const
+{
+  return m_indices.size();
+}
+
+bool knot_subset_t::empty() const
+{
+  return m_indices.empty();
+}
+
+void knot_subset_t::gather(const std::vector<double>& a_src, std::vector<double>& a_dst) const
+{
+  a_dst.resize(m_indices.size());
+  for (std::size_t i = 0; i < m_indices.size(); i++) {
+    assert(m_indices[i] < a_src.size());
+    a_dst[i] = a_src[m_indices[i]];
+  }
+}
+
+bool knot_subset_t::operator==(const knot_subset_t& a_other) const
+{
+  return m_indices == a_other.m_indices;
+}
+
+bool knot_subset_t::operator!=(const knot_subset_t& a_other) const
+{
+  return !(*this == a_other);
+}
@@ -0,0 +1,37 @@
+#ifndef KNOT_SUBSET_H
+#define KNOT_SUBSET_H
+
+#include <cstddef>
+#include <vector>
+
+//Knots selected for fitting, stored as sorted indices into the x array
+//of the series. Matching and extraction are linear, the index array
+//is reused between assignments
+class knot_subset_t
+{
+public:
+  knot_subset_t();
+
+  //Finds a_values in sorted a_x with one merge pass, unsorted a_values
+  //are sorted first. Returns false if some value is not in a_x,
+  //the found ones are kept anyway
+  bool assign(const std::vector<double>& a_x, const std::vector<double>& a_values);
+  //First and last knot of a_count
+  void assign_ends(std::size_t a_count);
+  void clear();
+
+  const std::vector<std::size_t>& indices() const;
+  std::size_t size() const;
+  bool empty() const;
+
+  //a_dst[i] = a_src[indices()[i]]
+  void gather(const std::vector<double>& a_src, std::vector<double>& a_dst) const;
+
+  bool operator==(const knot_subset_t& a_other) const;
+  bool operator!=(const knot_subset_t& a_other) const;
+private:
+  std::vector<std::size_t> m_indices;
+  std::vector<double> m_sorted_values;
+};
+
+#endif // KNOT_SUBSET_H
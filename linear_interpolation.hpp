@@ -1,8 +1,11 @@
 #include "interpolation_base.h"
+#include "instrumentation.h"
 
+#include <algorithm>
 #include <iostream>
 #include <vector>
 #include <map>
+#include <memory_resource>
 using namespace std;
 
 namespace irs {
@@ -21,20 +24,28 @@ void out_map(T& a_map)
   cout << endl;
 }
 
+//Map nodes are allocated from the memory resource given to the constructor
 template <class T>
 class line_interp_t : public interpolation_base_t
 {
 public:
 	line_interp_t();
+	explicit line_interp_t(pmr::memory_resource* ap_resource);
   virtual ~line_interp_t() override;
   virtual void set_points(const T* ap_x_carray, const T* ap_y_carray, size_t a_size) override;
   virtual T operator()(T x) override;
+  virtual interpolation_derivs_t calc_derivs(T x) override;
+	//Unlike operator() does not insert into the map, sorted a_x walk it
+	virtual void calc_array(const T* a_x, T* a_y, size_t a_count) override;
 
 	void add(T a_x, T a_y);
 	void clear();
 	void prepare();
 	void prepare_inv();
 	T calc_inv(T x);
+	//Integral from a_a to a_b, O(log n) via prefix sums stored in the points
+	T integrate(T a_a, T a_b);
+	void integrate(const T* ap_from, const T* ap_to, T* ap_result, size_t a_size);
 
 private:
 	struct point_info_t
@@ -42,11 +53,14 @@ private:
 	  T y;
 	  T k;
 	  T b;
+	  //Integral from the first point to this one
+	  T s;
 	  
 	  point_info_t():
 	  	y(0),
 	  	k(0),
-	  	b(0)
+	  	b(0),
+	  	s(0)
 	  {}
 	};
 	/*enum state_t { 
@@ -58,7 +72,7 @@ private:
 		point_list_size_limit = 2
 	};
 	
-	typedef map<T, point_info_t> point_list_type;
+	typedef pmr::map<T, point_info_t> point_list_type;
 	typedef typename point_list_type::value_type point_type;
 	typedef typename point_list_type::iterator plist_it_type;
 	
@@ -70,14 +84,24 @@ private:
 	point_type make_point(T a_x, T a_y);
 	T calc_helper(T x, point_list_type& a_point_list);
 	void prepare_helper(point_list_type& a_point_list);
+	T primitive(T x);
+	static T line_integral(T k, T b, T x1, T x2);
+	//Point that stores the line used for x, including extrapolation
+	plist_it_type line_for(T x);
 };
 
 template <class T>
 line_interp_t<T>::line_interp_t():
+	line_interp_t(pmr::get_default_resource())
+{
+}
+
+template <class T>
+line_interp_t<T>::line_interp_t(pmr::memory_resource* ap_resource):
 	m_ready(false),
-	m_point_list(),
+	m_point_list(ap_resource),
 	m_ready_inv(false),
-	m_point_list_inv()
+	m_point_list_inv(ap_resource)
 {
 }
 
@@ -115,6 +139,8 @@ void line_interp_t<T>::clear()
 template <class T>
 void line_interp_t<T>::set_points(const T* ap_x_carray, const T* ap_y_carray, size_t a_size)
 {
+  SPLINES_SCOPED_TIMER(itm_set_points);
+  SPLINES_COUNT(ic_fits);
   clear();
   const T* p_y_el = ap_y_carray;
   const T* p_x_el_last = ap_x_carray + a_size;
@@ -131,17 +157,68 @@ void line_interp_t<T>::prepare_helper(point_list_type& a_point_list)
 	plist_it_type it = a_point_list.begin();
 	T x1 = it->first;
 	T y1 = it->second.y;
+	T s1 = 0;
+	it->second.s = s1;
 	++it;
 	for (; it != a_point_list.end(); ++it) {
 		T x2 = it->first;
 		T y2 = it->second.y;
 	  it->second.k = (y2 - y1)/(x2 - x1);
 	  it->second.b = y1 - it->second.k*x1;
+	  s1 += (y1 + y2)*(x2 - x1)/2;
+	  it->second.s = s1;
 	  x1 = x2;
 	  y1 = y2;
 	}
 }
 
+template <class T>
+T line_interp_t<T>::line_integral(T k, T b, T x1, T x2)
+{
+	return (x2 - x1)*(k*(x1 + x2)/2 + b);
+}
+
+template <class T>
+T line_interp_t<T>::primitive(T x)
+{
+	plist_it_type first_it = m_point_list.begin();
+	plist_it_type it = m_point_list.upper_bound(x);
+	if (it == first_it) {
+		//Left extrapolation continues the first segment
+		plist_it_type second_it = first_it;
+		++second_it;
+		return line_integral(second_it->second.k, second_it->second.b,
+			first_it->first, x);
+	}
+	plist_it_type prev_it = it;
+	--prev_it;
+	//Right extrapolation continues the last segment
+	plist_it_type segment_it = (it == m_point_list.end()) ? prev_it : it;
+	return prev_it->second.s + line_integral(segment_it->second.k,
+		segment_it->second.b, prev_it->first, x);
+}
+
+template <class T>
+T line_interp_t<T>::integrate(T a_a, T a_b)
+{
+	if (m_point_list.size() < point_list_size_limit) {
+		return 0;
+	}
+	if (!m_ready) {
+		prepare();
+	}
+	return primitive(a_b) - primitive(a_a);
+}
+
+template <class T>
+void line_interp_t<T>::integrate(const T* ap_from, const T* ap_to, T* ap_result,
+	size_t a_size)
+{
+	for (size_t i = 0; i < a_size; i++) {
+		ap_result[i] = integrate(ap_from[i], ap_to[i]);
+	}
+}
+
 template <class T>
 void line_interp_t<T>::prepare()
 {
@@ -209,6 +286,7 @@ T line_interp_t<T>::calc_helper(T x, point_list_type& a_point_list)
 template <class T>
 T line_interp_t<T>::operator()(T x)
 {
+	SPLINES_COUNT(ic_evaluations);
 	if (m_point_list.size() < point_list_size_limit) {
 		return 0;
 	}
@@ -219,6 +297,87 @@ T line_interp_t<T>::operator()(T x)
 	return calc_helper(x, m_point_list);
 }
 
+template <class T>
+typename line_interp_t<T>::plist_it_type line_interp_t<T>::line_for(T x)
+{
+	plist_it_type it = m_point_list.upper_bound(x);
+	if (it == m_point_list.begin()) {
+		++it;
+	} else if (it == m_point_list.end()) {
+		--it;
+	}
+	return it;
+}
+
+template <class T>
+void line_interp_t<T>::calc_array(const T* a_x, T* a_y, size_t a_count)
+{
+	SPLINES_COUNT_N(ic_evaluations, a_count);
+	if (m_point_list.size() < point_list_size_limit) {
+		fill(a_y, a_y + a_count, T(0));
+		return;
+	}
+	if (!m_ready) {
+		prepare();
+	}
+	
+	//Same line as in calc_helper: the first point not less than x,
+	//the outer lines outside of the points
+	enum { max_walk_steps = 8 };
+	plist_it_type first_it = m_point_list.begin();
+	plist_it_type end_it = m_point_list.end();
+	plist_it_type it = end_it;
+	T prev_x = T(0);
+	for (size_t i = 0; i < a_count; i++) {
+		T x = a_x[i];
+		bool found = false;
+		if ((i != 0) && (x >= prev_x)) {
+			for (int step = 0; step < max_walk_steps; step++) {
+				if ((it == end_it) || !(it->first < x)) {
+					found = true;
+					break;
+				}
+				++it;
+			}
+		}
+		if (found) {
+			SPLINES_COUNT(ic_hinted_searches);
+		} else {
+			SPLINES_COUNT(ic_binary_searches);
+			it = m_point_list.lower_bound(x);
+		}
+		prev_x = x;
+		
+		plist_it_type target_it = it;
+		if (target_it == first_it) {
+			++target_it;
+		} else if (target_it == end_it) {
+			--target_it;
+		}
+		a_y[i] = target_it->second.k*x + target_it->second.b;
+	}
+}
+
+template <class T>
+interpolation_derivs_t line_interp_t<T>::calc_derivs(T x)
+{
+	interpolation_derivs_t derivs;
+	derivs.value = 0;
+	derivs.first = 0;
+	derivs.second = 0;
+	if (m_point_list.size() < point_list_size_limit) {
+		return derivs;
+	}
+	if (!m_ready) {
+		prepare();
+	}
+	
+	plist_it_type it = line_for(x);
+	derivs.value = it->second.k*x + it->second.b;
+	derivs.first = it->second.k;
+	return derivs;
+}
+
 template <class T>
 T line_interp_t<T>::calc_inv(T x)
 {
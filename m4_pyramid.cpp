@@ -0,0 +1,168 @@
+#include "m4_pyramid.h"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+
+m4_pyramid_t::m4_pyramid_t():
+  m_x(),
+  m_y(),
+  m_min_levels(),
+  m_max_levels()
+{
+}
+
+void m4_pyramid_t::assign(const std::vector<double>& a_x, const std::vector<double>& a_y)
+{
+  assert(a_x.size() == a_y.size());
+  m_x.assign(a_x.begin(), a_x.end());
+  m_y.assign(a_y.begin(), a_y.end());
+
+  //Level buffers are reused between assignments
+  std::size_t level_count = 0;
+  for (std::size_t size = m_y.size() / 2; size > 0; size /= 2) {
+    level_count++;
+  }
+  m_min_levels.resize(level_count);
+  m_max_levels.resize(level_count);
+
+  std::size_t prev_size = m_y.size();
+  for (std::size_t level = 1; level <= level_count; level++) {
+    const std::size_t size = prev_size / 2;
+    std::vector<std::size_t>& mins = m_min_levels[level - 1];
+    std::vector<std::size_t>& maxs = m_max_levels[level - 1];
+    mins.resize(size);
+    maxs.resize(size);
+    for (std::size_t i = 0; i < size; i++) {
+      const std::size_t left_min = min_node(level - 1, 2 * i);
+      const std::size_t right_min = min_node(level - 1, 2 * i + 1);
+      mins[i] = (m_y[right_min] < m_y[left_min]) ? right_min : left_min;
+      const std::size_t left_max = max_node(level - 1, 2 * i);
+      const std::size_t right_max = max_node(level - 1, 2 * i + 1);
+      maxs[i] = (m_y[right_max] > m_y[left_max]) ? right_max : left_max;
+    }
+    prev_size = size;
+  }
+}
+
+void m4_pyramid_t::clear()
+{
+  m_x.clear();
+  m_y.clear();
+  m_min_levels.clear();
+  m_max_levels.clear();
+}
+
+bool m4_pyramid_t::empty() const
+{
+  return m_x.empty();
+}
+
+std::size_t m4_pyramid_t::size() const
+{
+  return m_x.size();
+}
+
+std::size_t m4_pyramid_t::min_node(std::size_t a_level, std::size_t a_index) const
+{
+  return (a_level == 0) ? a_index : m_min_levels[a_level - 1][a_index];
+}
+
+std::size_t m4_pyramid_t::max_node(std::size_t a_level, std::size_t a_index) const
+{
+  return (a_level == 0) ? a_index : m_max_levels[a_level - 1][a_index];
+}
+
+void m4_pyramid_t::range_min_max(std::size_t a_begin, std::size_t a_end,
+  std::size_t& a_min, std::size_t& a_max) const
+{
+  assert(a_begin < a_end && a_end <= m_y.size());
+  a_min = a_begin;
+  a_max = a_begin;
+  //Bottom-up: an odd bound is a node whose pair is outside the range,
+  //it is taken alone and the bound moves to the next level
+  std::size_t begin = a_begin;
+  std::size_t end = a_end;
+  for (std::size_t level = 0; begin < end; level++) {
+    if (begin & 1) {
+      const std::size_t min = min_node(level, begin);
+      const std::size_t max = max_node(level, begin);
+      a_min = (m_y[min] < m_y[a_min]) ? min : a_min;
+      a_max = (m_y[max] > m_y[a_max]) ? max : a_max;
+      begin++;
+    }
+    if (end & 1) {
+      end--;
+      const std::size_t min = min_node(level, end);
+      const std::size_t max = max_node(level, end);
+      a_min = (m_y[min] < m_y[a_min]) ? min : a_min;
+      a_max = (m_y[max] > m_y[a_max]) ? max : a_max;
+    }
+    begin /= 2;
+    end /= 2;
+  }
+}
+
+void m4_pyramid_t::append_point(std::size_t a_index, std::vector<double>& a_x,
+  std::vector<double>& a_y) const
+{
+  a_x.push_back(m_x[a_index]);
+  a_y.push_back(m_y[a_index]);
+}
+
+void m4_pyramid_t::decimate(double a_min_x, double a_max_x, std::size_t a_columns,
+  std::vector<double>& a_x, std::vector<double>& a_y) const
+{
+  a_x.clear();
+  a_y.clear();
+  if (m_x.empty()) {
+    return;
+  }
+  std::size_t begin = static_cast<std::size_t>(
+    std::lower_bound(m_x.begin(), m_x.end(), a_min_x) - m_x.begin());
+  std::size_t end = static_cast<std::size_t>(
+    std::upper_bound(m_x.begin(), m_x.end(), a_max_x) - m_x.begin());
+  begin = (begin > 0) ? begin - 1 : begin;
+  end = (end < m_x.size()) ? end + 1 : end;
+  if (begin >= end) {
+    return;
+  }
+
+  if ((a_columns == 0) || !(a_max_x > a_min_x) || (end - begin <= 4 * a_columns)) {
+    a_x.assign(m_x.begin() + static_cast<std::ptrdiff_t>(begin),
+      m_x.begin() + static_cast<std::ptrdiff_t>(end));
+    a_y.assign(m_y.begin() + static_cast<std::ptrdiff_t>(begin),
+      m_y.begin() + static_cast<std::ptrdiff_t>(end));
+    return;
+  }
+
+  a_x.reserve(4 * a_columns + 2);
+  a_y.reserve(4 * a_columns + 2);
+  const double column_width = (a_max_x - a_min_x) / static_cast<double>(a_columns);
+  std::size_t column_begin = begin;
+  //The outside points fall into the first and the last column
+  for (std::size_t column = 0; (column < a_columns) && (column_begin < end); column++) {
+    std::size_t column_end = end;
+    if (column + 1 < a_columns) {
+      const double column_max_x = a_min_x + static_cast<double>(column + 1) * column_width;
+      column_end = static_cast<std::size_t>(std::lower_bound(
+        m_x.begin() + static_cast<std::ptrdiff_t>(column_begin),
+        m_x.begin() + static_cast<std::ptrdiff_t>(end), column_max_x) - m_x.begin());
+    }
+    if (column_end - column_begin <= 4) {
+      for (std::size_t i = column_begin; i < column_end; i++) {
+        append_point(i, a_x, a_y);
+      }
+    } else {
+      std::array<std::size_t, 4> indices = { column_begin, 0, 0, column_end - 1 };
+      range_min_max(column_begin, column_end, indices[1], indices[2]);
+      std::sort(indices.begin() + 1, indices.begin() + 3);
+      for (std::size_t i = 0; i < indices.size(); i++) {
+        if ((i == 0) || (indices[i] != indices[i - 1])) {
+          append_point(indices[i], a_x, a_y);
+        }
+      }
+    }
+    column_begin = column_end;
+  }
+}
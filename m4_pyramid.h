@@ -0,0 +1,46 @@
+#ifndef M4_PYRAMID_H
+#define M4_PYRAMID_H
+
+#include <cstddef>
+#include <vector>
+
+//M4 decimation of a long line for drawing: in every pixel column only
+//the first, last, min and max point are kept, which draws the same pixels
+//as the whole line. Min and max of any index range come from a pyramid
+//of pairwise min/max indices built once, so decimating any X range
+//costs O(columns * log(points)) instead of a pass over the points
+class m4_pyramid_t
+{
+public:
+  m4_pyramid_t();
+
+  //Copies the line and builds the pyramid in O(n), a_x must be sorted
+  void assign(const std::vector<double>& a_x, const std::vector<double>& a_y);
+  void clear();
+  bool empty() const;
+  std::size_t size() const;
+
+  //Points of [a_min_x, a_max_x] split into a_columns equal columns, with the
+  //nearest point outside on each side so that the line reaches the edges.
+  //If there are no more than 4 points per column all of them are returned
+  void decimate(double a_min_x, double a_max_x, std::size_t a_columns,
+    std::vector<double>& a_x, std::vector<double>& a_y) const;
+
+  //Indices of the min and max Y in [a_begin, a_end), the range must not be empty
+  void range_min_max(std::size_t a_begin, std::size_t a_end,
+    std::size_t& a_min, std::size_t& a_max) const;
+private:
+  std::vector<double> m_x;
+  std::vector<double> m_y;
+  //Level k + 1 node i covers points [i * 2^(k + 1), (i + 1) * 2^(k + 1)),
+  //level 0 are the points themselves and is not stored
+  std::vector<std::vector<std::size_t>> m_min_levels;
+  std::vector<std::vector<std::size_t>> m_max_levels;
+
+  std::size_t min_node(std::size_t a_level, std::size_t a_index) const;
+  std::size_t max_node(std::size_t a_level, std::size_t a_index) const;
+  void append_point(std::size_t a_index, std::vector<double>& a_x,
+    std::vector<double>& a_y) const;
+};
+
+#endif // M4_PYRAMID_H
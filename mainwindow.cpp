@@ -1,5 +1,9 @@
 #include "mainwindow.h"
 #include "ui_mainwindow.h"
+#include "input_normalization.h"
+#include "knot_subset.h"
+#include "instrumentation.h"
+#include "table_fit.h"
 
 
 #include <cmath>
@@ -7,19 +11,32 @@
 #include <QCheckBox>
 #include <QLabel>
 #include <QFileDialog>
+#include <QApplication>
+#include <QFile>
 #include <chrono>
 
+namespace {
+
+//Index of the point in m_x, stored in every point checkbox
+const char* const point_index_property = "point_index";
+//Series with more points are drawn with OpenGL
+const int opengl_point_threshold = 10000;
+//Pixel columns for decimation before the chart is laid out
+const qreal default_plot_columns = 1920;
+
+} // namespace
+
 MainWindow::MainWindow(QWidget *parent) :
   QMainWindow(parent),
   ui(new Ui::MainWindow),
   m_x(),
   m_y(),
   m_correct_points { 40, 47, 70, 120, 300, 1000, 1400, 2000 },
-  m_points_map(),
-  m_cubic_spline(),
-  m_hermite_spline(),
-  m_linear_interpolation(),
+  m_fit_points(),
   m_interpolation_data(),
+  mp_fit_worker(new fit_worker_t(this)),
+  m_job_auto_scale(true),
+  m_table_fit_file_name(),
   m_data_series(new QLineSeries(this)),
   mp_axisX(new QValueAxis(this)),
   m_min_x(0),
@@ -38,22 +55,38 @@ MainWindow::MainWindow(QWidget *parent) :
   m_default_color(),
   m_mark_limit(0.01),
   m_draw_relative_points(false),
+  m_current_x(0),
+  m_draw_y(),
+  m_data_pyramid(),
+  m_data_pyramid_valid(false),
+  m_data_min_y(0),
+  m_data_max_y(0),
+  m_data_min_x(0),
+  m_data_max_x(0),
+  m_data_x(),
+  m_data_y(),
   m_tick_interval_count(10),
   m_start_zoom(),
   m_zoom_stack(),
   m_save_zoom(false),
-  m_points_importer(new import_points_t(m_correct_points, this))
+  m_points_importer(new import_points_t(m_correct_points, this)),
+  mp_profiling_panel(nullptr)
 {
   ui->setupUi(this);
 
   m_interpolation_data.reserve(it_count);
   //    enum interpolation_type_t
-  m_interpolation_data.emplace_back(new interpolation_t(m_cubic_spline, new QLineSeries(this)));
-  m_interpolation_data.emplace_back(new interpolation_t(m_hermite_spline, new QLineSeries(this)));
-  m_interpolation_data.emplace_back(new interpolation_t(m_linear_interpolation, new QLineSeries(this)));
+  for (size_t type = 0; type < it_count; type++) {
+    m_interpolation_data.emplace_back(new interpolation_t(new QLineSeries(this)));
+  }
 
   create_chart();
   connect(m_points_importer, &import_points_t::points_are_ready, this, &MainWindow::update_points);
+  //    ,     GUI 
+  connect(mp_fit_worker, &fit_worker_t::fit_done, this, &MainWindow::apply_fit_result,
+    Qt::QueuedConnection);
+  connect(mp_fit_worker, &fit_worker_t::table_fit_done, this,
+    &MainWindow::apply_table_fit_result, Qt::QueuedConnection);
 }
 
 MainWindow::~MainWindow()
@@ -71,12 +104,15 @@ void MainWindow::create_chart()
   mp_axisY->setLabelFormat("%g");
 
   m_data_series->setName("Input data");
-  m_interpolation_data[it_cubic]->series->setName("Cubic");
+  for (size_t type = 0; type < it_count; type++) {
+    m_interpolation_data[type]->series->setName(
+      interpolation_name(static_cast<interpolation_type_t>(type)));
+  }
   m_interpolation_data[it_cubic]->enable = ui->draw_cubic_checkbox->isChecked();
-  m_interpolation_data[it_hermite]->series->setName("Hermite");
   m_interpolation_data[it_hermite]->enable = ui->draw_hermite_checkbox->isChecked();
-  m_interpolation_data[it_linear]->series->setName("Linear");
   m_interpolation_data[it_linear]->enable = ui->draw_linear_checkbox->isChecked();
+  m_interpolation_data[it_akima]->enable = ui->draw_akima_checkbox->isChecked();
+  m_interpolation_data[it_makima]->enable = ui->draw_makima_checkbox->isChecked();
 
   chart->addSeries(m_data_series);
   m_data_series->attachAxis(mp_axisX);
@@ -93,9 +129,9 @@ void MainWindow::create_chart()
 
   QHBoxLayout* header = new QHBoxLayout();
   header->addWidget(new QLabel("X", this));
-  header->addWidget(new QLabel("Cubic", this));
-  header->addWidget(new QLabel("Hermite", this));
-  header->addWidget(new QLabel("Linear", this));
+  for (size_t type = 0; type < it_count; type++) {
+    header->addWidget(new QLabel(interpolation_name(static_cast<interpolation_type_t>(type)), this));
+  }
   ui->buttons_layout->addLayout(header);
   ui->buttons_layout->addStretch();
 
@@ -106,52 +142,23 @@ void MainWindow::create_chart()
 
   connect(mp_axisX, &QValueAxis::rangeChanged, this, &MainWindow::chart_was_zoomed);
   connect(mp_axisY, &QValueAxis::rangeChanged, this, &MainWindow::chart_was_zoomed);
+  connect(chart, &QChart::plotAreaChanged, this, &MainWindow::plot_area_changed);
 }
 
-void MainWindow::calc_splines(const vector<double> &a_correct_points)
-{
-  assert(m_x.size() == m_y.size());
-  m_points_map.clear();
-
-  for (size_t i = 0; i < m_x.size(); i++) {
-    m_points_map[m_x[i]] = m_y[i];
-  }
-
-  vector<double> correct_values;
-  for (auto point: a_correct_points) {
-    auto value = m_points_map.find(point);
-    if (value != m_points_map.end()) {
-      correct_values.push_back(value->second);
-    }
-  }
-
-  for (auto &interp_data: m_interpolation_data) {
-    interp_data->interpolation.set_points(a_correct_points.data(), correct_values.data(), a_correct_points.size());
-  }
-  calc_deviations();
-}
-
-double MainWindow::deviation(double a_real, double a_calculated)
-{
-  return (a_real - a_calculated) / a_calculated * 100;
-}
-
-void MainWindow::calc_deviations()
+void MainWindow::calc_deviations(const fit_result_t& a_result)
 {
   for (auto& interp_data: m_interpolation_data) {
     interp_data->worst_point.clear();
   }
 
-  size_t point_number = 0;
-  for (auto &a_pair: m_points_map) {
-    double real_value = a_pair.second;
-
-    for (auto& interp_data: m_interpolation_data) {
+  for (size_t point_number = 0; point_number < m_x.size(); point_number++) {
+    for (size_t type = 0; type < it_count; type++) {
+      auto& interp_data = m_interpolation_data[type];
+      const vector<double>& deviations = a_result.deviations[type];
       interp_data->deviation_labels[point_number]->setPalette(m_default_color);
 
-      if (interp_data->enable) {
-        double interp_value = interp_data->interpolation(a_pair.first);
-        double interp_deviation = deviation(real_value, interp_value);
+      if (interp_data->enable && !deviations.empty()) {
+        double interp_deviation = deviations[point_number];
 
         interp_data->deviation_labels[point_number]->setText(QString::number(interp_deviation));
 
@@ -165,7 +172,6 @@ void MainWindow::calc_deviations()
         interp_data->deviation_labels[point_number]->setText("");
       }
     }
-    point_number++;
   }
   for (auto& interp_data: m_interpolation_data) {
     if (interp_data->enable) {
@@ -174,28 +180,120 @@ void MainWindow::calc_deviations()
   }
 }
 
-void MainWindow::repaint_data_line()
+output_transform_t MainWindow::make_output_transform()
 {
-  m_data_series->clear();
-  double current_x = m_points_importer->get_x().replace(",", ".").toDouble();
+  output_transform_t transform;
+  if (m_draw_relative_points) {
+    switch(m_points_importer->get_select_type()) {
+      case import_points_dialog_t::select_t::cols: {
+        transform.divide_by_x();
+      } break;
+      case import_points_dialog_t::select_t::rows: {
+        transform.divide(m_current_x);
+      } break;
+      default: {
+      } break;
+    }
+  }
+  return transform;
+}
+
+void MainWindow::set_series_points(QLineSeries* ap_series, const output_transform_t& a_transform,
+  const vector<double>& a_x, const vector<double>& a_y, double& a_min_y, double& a_max_y)
+{
+  a_transform.apply(a_x, a_y, m_draw_y);
+
+  //      replace: append  
+  //      .
+  //     (implicit sharing),   
+  //:        .
+  // Y     .
+  //QLineSeries     NaN,   Y
+  //(log10  y <= 0,   x == 0)    
+  const int count = static_cast<int>(a_x.size());
+  QVector<QPointF> series_points(count);
+  QPointF* points = series_points.data();
+  int kept = 0;
+  double min_y = a_min_y;
+  double max_y = a_max_y;
+  for (int i = 0; i < count; i++) {
+    const double y = m_draw_y[static_cast<size_t>(i)];
+    if (std::isfinite(y)) {
+      points[kept++] = QPointF(a_x[static_cast<size_t>(i)], y);
+      min_y = min_y > y ? y : min_y;
+      max_y = max_y < y ? y : max_y;
+    }
+  }
+  series_points.resize(kept);
+  a_min_y = min_y;
+  a_max_y = max_y;
 
-  for (size_t i = 0; i < m_x.size(); i++) {
-    double value = m_y[i];
-    if (m_draw_relative_points) {
-      switch(m_points_importer->get_select_type()) {
-        case import_points_dialog_t::select_t::cols: {
-          value = value / m_x[i];
-        } break;
-        case import_points_dialog_t::select_t::rows: {
-          value = value / current_x;
-        } break;
-        default: {
-        } break;
+  const bool use_opengl = count > opengl_point_threshold;
+  if (ap_series->useOpenGL() != use_opengl) {
+    ap_series->setUseOpenGL(use_opengl);
+  }
+  ap_series->replace(series_points);
+  SPLINES_COUNT_N(ic_rendered_points, a_x.size());
+}
+
+void MainWindow::repaint_data_line(const output_transform_t& a_transform)
+{
+  if (!m_data_pyramid_valid) {
+    //     Y:   x
+    //    
+    a_transform.apply(m_x, m_y, m_draw_y);
+    // Y    :   NaN
+    //     
+    vector<double> finite_x;
+    vector<double> finite_y;
+    finite_x.reserve(m_x.size());
+    finite_y.reserve(m_x.size());
+    m_data_min_y = std::numeric_limits<double>::max();
+    m_data_max_y = -std::numeric_limits<double>::max();
+    for (size_t i = 0; i < m_x.size(); i++) {
+      const double y = m_draw_y[i];
+      if (std::isfinite(y)) {
+        finite_x.push_back(m_x[i]);
+        finite_y.push_back(y);
+        m_data_min_y = m_data_min_y > y ? y : m_data_min_y;
+        m_data_max_y = m_data_max_y < y ? y : m_data_max_y;
       }
     }
-    m_min_y = m_min_y > value ? value : m_min_y;
-    m_max_y = m_max_y < value ? value : m_max_y;
-    m_data_series->append(m_x[i], value);
+    m_data_pyramid.assign(finite_x, finite_y);
+    m_data_pyramid_valid = true;
+  }
+  //  Y   ,    
+  m_min_y = m_min_y > m_data_min_y ? m_data_min_y : m_min_y;
+  m_max_y = m_max_y < m_data_max_y ? m_data_max_y : m_max_y;
+  if (m_auto_scale) {
+    decimate_data_line(m_min_x, m_max_x);
+  } else {
+    decimate_data_line(mp_axisX->min(), mp_axisX->max());
+  }
+}
+
+void MainWindow::decimate_data_line(double a_min_x, double a_max_x)
+{
+  //  4    : , , 
+  // ,       
+  QRectF plot_area = ui->chart_widget->chart()->plotArea();
+  qreal columns = plot_area.width() * ui->chart_widget->devicePixelRatioF();
+  if (columns < 1) {
+    columns = default_plot_columns;
+  }
+  m_data_pyramid.decimate(a_min_x, a_max_x, static_cast<size_t>(std::ceil(columns)),
+    m_data_x, m_data_y);
+  m_data_min_x = a_min_x;
+  m_data_max_x = a_max_x;
+  double min_y = 0;
+  double max_y = 0;
+  set_series_points(m_data_series, output_transform_t(), m_data_x, m_data_y, min_y, max_y);
+}
+
+void MainWindow::plot_area_changed(const QRectF& /*a_plot_area*/)
+{
+  if (m_data_pyramid_valid) {
+    decimate_data_line(m_data_min_x, m_data_max_x);
   }
 }
 
@@ -206,40 +304,27 @@ void MainWindow::set_nice_axis_numbers(QValueAxis *a_axis, double a_min, double
   a_axis->setTickType(QValueAxis::TickType::TicksDynamic);
 }
 
-void MainWindow::draw_lines(double a_min, double a_max, double a_step)
+void MainWindow::draw_lines(const fit_result_t& a_result)
 {
+  SPLINES_SCOPED_TIMER(itm_draw_lines);
   mp_axisX->setTickType(QValueAxis::TickType::TicksFixed);
   mp_axisY->setTickType(QValueAxis::TickType::TicksFixed);
 
   m_min_y = std::numeric_limits<double>::max();
   m_max_y = std::numeric_limits<double>::min();
 
-  repaint_data_line();
-
-  double current_x = m_points_importer->get_x().replace(",", ".").toDouble();
-
-  for (auto& interp: m_interpolation_data) {
-    interp->series->clear();
-
-    if (interp->enable) {
-      for (double x = a_min; x < a_max; x += a_step) {
-        double interpolation_value = interp->interpolation(x);
-        if (m_draw_relative_points) {
-          switch(m_points_importer->get_select_type()) {
-            case import_points_dialog_t::select_t::cols: {
-              interpolation_value = interpolation_value / x;
-            } break;
-            case import_points_dialog_t::select_t::rows: {
-              interpolation_value = interpolation_value / current_x;
-            } break;
-            default: {
-            } break;
-          }
-        }
-        m_min_y = m_min_y > interpolation_value ? interpolation_value : m_min_y;
-        m_max_y = m_max_y < interpolation_value ? interpolation_value : m_max_y;
-        interp->series->append(x, interpolation_value);
-      }
+  //     
+  //    
+  output_transform_t transform = make_output_transform();
+  repaint_data_line(transform);
+
+  for (size_t type = 0; type < it_count; type++) {
+    auto& interp = m_interpolation_data[type];
+    const vector<double>& sample_y = a_result.sample_y[type];
+    if (interp->enable && !sample_y.empty()) {
+      set_series_points(interp->series, transform, a_result.sample_x, sample_y, m_min_y, m_max_y);
+    } else {
+      interp->series->clear();
     }
   }
 
@@ -287,15 +372,20 @@ void MainWindow::redraw_spline(bool a_checked)
 {
   QObject* obj = QObject::sender();
   QCheckBox* pressed_cb = qobject_cast<QCheckBox*>(obj);
-  double point_val = double(pressed_cb->text().toDouble());
+  //  ,     m_x  
+  size_t point_index = pressed_cb->property(point_index_property).value<size_t>();
+  double point_val = m_x[point_index];
+  auto point_it = std::lower_bound(m_correct_points.begin(), m_correct_points.end(), point_val);
 
   if (a_checked) {
-    m_correct_points.push_back(point_val);
-    std::sort(m_correct_points.begin(), m_correct_points.end());
+    if (point_it == m_correct_points.end() || *point_it != point_val) {
+      m_correct_points.insert(point_it, point_val);
+    }
   } else {
     if (m_correct_points.size() > 2) {
-      m_correct_points.erase(std::remove(m_correct_points.begin(), m_correct_points.end(), point_val),
-        m_correct_points.end());
+      if (point_it != m_correct_points.end() && *point_it == point_val) {
+        m_correct_points.erase(point_it);
+      }
     } else {
       pressed_cb->setChecked(true);
     }
@@ -303,7 +393,7 @@ void MainWindow::redraw_spline(bool a_checked)
   repaint_spline();
 }
 
-MainWindow::input_data_error_t MainWindow::verify_data(const vector<double>& a_x, const vector<double>& a_y)
+MainWindow::input_data_error_t MainWindow::verify_data(vector<double>& a_x, vector<double>& a_y)
 {
   if (a_x.empty() || a_y.empty()) {
     return input_data_error_t::no_data;
@@ -311,26 +401,29 @@ MainWindow::input_data_error_t MainWindow::verify_data(const vector<double>& a_x
   if (a_x.size() != a_y.size()) {
     return input_data_error_t::arrays_not_same_size;
   }
+  //  ,    x ,
+  //NaN 
+  normalize_points(a_x, a_y, duplicate_policy_t::mean);
   if (a_x.size() < 2) {
     return input_data_error_t::not_enough_points;
   }
-  for(size_t i = 1; i < a_x.size(); i++) {
-    if (a_x[i] <= a_x[i-1]) {
-      return input_data_error_t::not_increasing_sequence;
-    }
-  }
   return input_data_error_t::none;
 }
 
 void MainWindow::create_control(const vector<double>& a_x)
 {
   delete ui->buttons_layout->takeAt(ui->buttons_layout->count() - 1);
+  knot_subset_t knots;
+  knots.assign(a_x, m_correct_points);
+  auto knot_it = knots.indices().begin();
   for (size_t i = 0; i < a_x.size(); i++) {
     auto x = a_x[i];
 
     QCheckBox* point_checkbox = new QCheckBox(QString::number(x), this);
-    if (std::find(m_correct_points.begin(), m_correct_points.end(), x) != m_correct_points.end()) {
+    point_checkbox->setProperty(point_index_property, QVariant::fromValue(i));
+    if (knot_it != knots.indices().end() && *knot_it == i) {
       point_checkbox->setChecked(true);
+      ++knot_it;
     }
     connect(point_checkbox, &QCheckBox::clicked, this, &MainWindow::redraw_spline);
 
@@ -384,10 +477,84 @@ void MainWindow::reinit_control_buttons()
 void MainWindow::repaint_spline()
 {
   if (!m_x.empty()) {
-    m_save_zoom = false;
-    calc_splines(m_correct_points);
-    draw_lines(m_min_x, m_max_x, m_x_step);
-    m_save_zoom = true;
+    fit_job_t job;
+    job.series_id = m_points_importer->get_series_id();
+    job.points = m_fit_points;
+    job.knots.assign(m_x, m_correct_points);
+    for (size_t type = 0; type < it_count; type++) {
+      job.enable[type] = m_interpolation_data[type]->enable;
+    }
+    job.min_x = m_min_x;
+    job.max_x = m_max_x;
+    job.step = m_x_step;
+    //   ,      
+    m_job_auto_scale = m_auto_scale;
+    mp_fit_worker->submit(std::move(job));
+  }
+}
+
+void MainWindow::apply_fit_result(std::size_t a_generation, std::shared_ptr<const fit_result_t> a_result)
+{
+  if (a_generation != mp_fit_worker->generation()) {
+    //  ,   
+    return;
+  }
+  SPLINES_SCOPED_TIMER(itm_redraw);
+  bool prev_auto_scale = m_auto_scale;
+  m_auto_scale = m_job_auto_scale;
+  m_save_zoom = false;
+  calc_deviations(*a_result);
+  draw_lines(*a_result);
+  m_save_zoom = true;
+  m_auto_scale = prev_auto_scale;
+
+  prefetch_neighbours();
+}
+
+void MainWindow::prefetch_neighbours()
+{
+  // /  ,    W/A/S/D
+  //    .    ,
+  //  update_points  reinit_control_buttons  
+  mp_fit_worker->start_prefetch_round();
+
+  const import_points_t::move_direction_t directions[] = {
+    import_points_t::move_direction_t::up,
+    import_points_t::move_direction_t::down,
+    import_points_t::move_direction_t::left,
+    import_points_t::move_direction_t::right
+  };
+  std::uint64_t current_id = m_points_importer->get_series_id();
+  for (auto direction: directions) {
+    import_points_dialog_t::select_t select = import_points_dialog_t::select_t::none;
+    int index = 0;
+    if (!m_points_importer->get_next_position(direction, select, index)) {
+      continue;
+    }
+    std::uint64_t series_id = m_points_importer->get_series_id(select, index);
+    if (series_id == current_id) {
+      continue;
+    }
+
+    std::shared_ptr<fit_points_t> points = std::make_shared<fit_points_t>();
+    m_points_importer->fill_x_y_arrays(select, index, points->x, points->y);
+    if (verify_data(points->x, points->y) != input_data_error_t::none) {
+      continue;
+    }
+
+    fit_job_t job;
+    job.series_id = series_id;
+    if ((m_correct_points.size() < 2) || !job.knots.assign(points->x, m_correct_points)) {
+      job.knots.assign_ends(points->x.size());
+    }
+    for (size_t type = 0; type < it_count; type++) {
+      job.enable[type] = m_interpolation_data[type]->enable;
+    }
+    job.min_x = points->x.front();
+    job.max_x = points->x.back();
+    job.step = m_auto_step ? (points->x.back() - points->x.front()) / 400 : m_x_step;
+    job.points = std::move(points);
+    mp_fit_worker->prefetch(std::move(job));
   }
 }
 
@@ -399,6 +566,9 @@ void MainWindow::update_points(vector<double> &a_x, vector<double> &a_y)
     case input_data_error_t::none: {
       m_x = std::move(a_x);
       m_y = std::move(a_y);
+      m_fit_points = std::make_shared<const fit_points_t>(fit_points_t{ m_x, m_y });
+      m_current_x = m_points_importer->get_x_value();
+      m_data_pyramid_valid = false;
 
       reinit_control_buttons();
       repaint_spline();
@@ -417,9 +587,6 @@ void MainWindow::update_points(vector<double> &a_x, vector<double> &a_y)
     case input_data_error_t::not_enough_points: {
       QMessageBox::critical(this, "Error", "Not enough points to calculate spline");
     } break;
-    case input_data_error_t::not_increasing_sequence: {
-      QMessageBox::critical(this, "Error", "X array must be strictly increasing sequence ");
-    } break;
   }
 }
 
@@ -463,6 +630,10 @@ void MainWindow::chart_was_zoomed(qreal a_min, qreal a_max)
   QValueAxis* zoomed_axis = qobject_cast<QValueAxis*>(obj);
   set_nice_axis_numbers(zoomed_axis, a_min, a_max, m_tick_interval_count);
 
+  if ((zoomed_axis == mp_axisX) && m_data_pyramid_valid &&
+    ((a_min != m_data_min_x) || (a_max != m_data_max_x))) {
+    decimate_data_line(a_min, a_max);
+  }
   if (zoomed_axis == mp_axisY) {
     if (m_save_zoom) {
       //  Y      X
@@ -499,6 +670,71 @@ void MainWindow::on_open_file_button_clicked()
   m_points_importer->create_import_points_dialog(this);
 }
 
+void MainWindow::on_profiling_button_clicked()
+{
+  //   ,     
+  //   
+  if (!mp_profiling_panel) {
+    mp_profiling_panel = new profiling_panel_t(this);
+  }
+  mp_profiling_panel->show();
+  mp_profiling_panel->raise();
+}
+
+void MainWindow::on_fit_table_button_clicked()
+{
+  table_fit_options_t options;
+  switch (m_points_importer->get_select_type()) {
+    case import_points_dialog_t::select_t::rows: {
+      options.select = table_select_t::row;
+    } break;
+    case import_points_dialog_t::select_t::cols: {
+      options.select = table_select_t::col;
+    } break;
+    default: {
+      QMessageBox::critical(this, "Error", "Select a row or a column of a table first");
+      return;
+    }
+  }
+  QString file_name = QFileDialog::getSaveFileName(this, tr("Save table fit report"), "",
+    tr("CSV (*.csv)"));
+  if (file_name.isEmpty()) {
+    return;
+  }
+  //  ,     ,    
+  // 
+  options.knots = m_correct_points;
+  for (size_t type = 0; type < it_count; type++) {
+    options.enable[type] = m_interpolation_data[type]->enable;
+  }
+
+  //  ,   .    
+  //       
+  m_table_fit_file_name = file_name;
+  ui->fit_table_button->setEnabled(false);
+  mp_fit_worker->submit_table(std::make_shared<const table_t>(m_points_importer->get_table()),
+    std::move(options));
+}
+
+void MainWindow::apply_table_fit_result(std::size_t a_generation,
+  std::shared_ptr<const table_fit_result_t> a_result)
+{
+  if (a_generation != mp_fit_worker->table_generation()) {
+    return;
+  }
+  ui->fit_table_button->setEnabled(true);
+
+  const std::string& report = a_result->report;
+  QFile file(m_table_fit_file_name);
+  if (!file.open(QIODevice::WriteOnly) ||
+    (file.write(report.data(), static_cast<qint64>(report.size())) !=
+    static_cast<qint64>(report.size()))) {
+    QMessageBox::critical(this, "Error", "Can't write file");
+    return;
+  }
+  QMessageBox::information(this, "Table fit", QString::fromStdString(a_result->summary));
+}
+
 void MainWindow::on_xmin_spinbox_valueChanged(double a_val)
 {
   m_min_x = a_val;
@@ -519,6 +755,7 @@ void MainWindow::on_xstep_spinbox_valueChanged(double a_val)
 void MainWindow::on_checkBox_stateChanged(int a_state)
 {
   m_draw_relative_points = a_state;
+  m_data_pyramid_valid = false;
   repaint_spline();
 }
 
@@ -564,3 +801,15 @@ void MainWindow::on_draw_hermite_checkbox_stateChanged(int a_state)
   m_interpolation_data[it_hermite]->enable = a_state;
   repaint_spline();
 }
+
+void MainWindow::on_draw_akima_checkbox_stateChanged(int a_state)
+{
+  m_interpolation_data[it_akima]->enable = a_state;
+  repaint_spline();
+}
+
+void MainWindow::on_draw_makima_checkbox_stateChanged(int a_state)
+{
+  m_interpolation_data[it_makima]->enable = a_state;
+  repaint_spline();
+}
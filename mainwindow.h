@@ -16,11 +16,12 @@
 #include <memory>
 #include <stack>
 
-#include "spline.h"
-#include "hermit.h"
+#include "fit_worker.h"
 #include "import_points.h"
-#include "linear_interpolation.hpp"
+#include "m4_pyramid.h"
+#include "output_transform.h"
 #include "peak_searcher.h"
+#include "profiling_panel.h"
 
 using namespace std;
 
@@ -56,32 +57,30 @@ private slots:
   void on_draw_linear_checkbox_stateChanged(int arg1);
   void on_draw_cubic_checkbox_stateChanged(int arg1);
   void on_draw_hermite_checkbox_stateChanged(int arg1);
+  void on_draw_akima_checkbox_stateChanged(int arg1);
+  void on_draw_makima_checkbox_stateChanged(int arg1);
+  void apply_fit_result(std::size_t a_generation, std::shared_ptr<const fit_result_t> a_result);
+  void apply_table_fit_result(std::size_t a_generation,
+    std::shared_ptr<const table_fit_result_t> a_result);
+  void on_profiling_button_clicked();
+  void on_fit_table_button_clicked();
+  void plot_area_changed(const QRectF& a_plot_area);
 
 private:
   enum class input_data_error_t {
     none,
     no_data,
     not_enough_points,
-    not_increasing_sequence,
     arrays_not_same_size
   };
 
-  enum interpolation_type_t {
-    it_cubic = 0,
-    it_hermite = 1,
-    it_linear = 2,
-    it_count = 3
-  };
-
   struct interpolation_t {
-    interpolation_base_t &interpolation;
     QLineSeries* series;
     vector<QLabel*> deviation_labels;
     peak_searcher_t<double> worst_point;
     bool enable;
 
-    interpolation_t(interpolation_base_t &a_interpolation, QLineSeries *a_series):
-      interpolation(a_interpolation),
+    interpolation_t(QLineSeries *a_series):
       series(a_series),
       deviation_labels(),
       worst_point(),
@@ -95,12 +94,12 @@ private:
   vector<double> m_x;
   vector<double> m_y;
   vector<double> m_correct_points;
-  std::map<double,double> m_points_map;
+  std::shared_ptr<const fit_points_t> m_fit_points;
 
-  ::tk::spline m_cubic_spline;
-  pchip_t<double> m_hermite_spline;
-  irs::line_interp_t<double> m_linear_interpolation;
   vector<std::unique_ptr<interpolation_t>> m_interpolation_data;
+  fit_worker_t* mp_fit_worker;
+  bool m_job_auto_scale;
+  QString m_table_fit_file_name;
 
   QLineSeries *m_data_series;
 
@@ -125,6 +124,21 @@ private:
 
   double m_mark_limit;
   bool m_draw_relative_points;
+  //X of the current series, parsed once per update_points
+  double m_current_x;
+  //Transformed Y of one curve, reused between redraws
+  vector<double> m_draw_y;
+  //Transformed input data for M4 decimation, rebuilt when the points
+  //or the transform change
+  m4_pyramid_t m_data_pyramid;
+  bool m_data_pyramid_valid;
+  double m_data_min_y;
+  double m_data_max_y;
+  //X range of the drawn data line and its decimated points
+  double m_data_min_x;
+  double m_data_max_x;
+  vector<double> m_data_x;
+  vector<double> m_data_y;
   size_t m_tick_interval_count;
 
   QRectF m_start_zoom;
@@ -132,19 +146,23 @@ private:
   bool m_save_zoom;
 
   import_points_t* m_points_importer;
+  profiling_panel_t* mp_profiling_panel;
 
   void create_chart();
   void create_control(const vector<double>& a_x);
-  input_data_error_t verify_data(const vector<double>& a_x, const vector<double>& a_y);
-  void calc_splines(const vector<double> &a_correct_points);
-  double deviation(double a_real, double a_calculated);
-  void calc_deviations();
+  input_data_error_t verify_data(vector<double>& a_x, vector<double>& a_y);
+  void calc_deviations(const fit_result_t& a_result);
   void set_nice_axis_numbers(QValueAxis *a_axis, double a_min, double a_max, size_t a_ticks_count);
-  void draw_lines(double a_min, double a_max, double a_step);
+  void draw_lines(const fit_result_t& a_result);
   double calc_chart_tick_interval(double a_min, double a_max, size_t a_ticks_count);
 
-  void repaint_data_line();
+  output_transform_t make_output_transform();
+  void repaint_data_line(const output_transform_t& a_transform);
+  void set_series_points(QLineSeries* ap_series, const output_transform_t& a_transform,
+    const vector<double>& a_x, const vector<double>& a_y, double& a_min_y, double& a_max_y);
+  void decimate_data_line(double a_min_x, double a_max_x);
   void repaint_spline();
+  void prefetch_neighbours();
 
   void delete_deviation_layouts();
   void reinit_control_buttons();
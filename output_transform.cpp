@@ -0,0 +1,85 @@
+#include "output_transform.h"
+
+#include <cmath>
+#include <limits>
+
+output_transform_t::output_transform_t():
+  m_stages()
+{
+}
+
+output_transform_t& output_transform_t::divide_by_x()
+{
+  m_stages.emplace_back(stage_kind_t::divide_by_x, 0);
+  return *this;
+}
+
+output_transform_t& output_transform_t::divide(double a_divisor)
+{
+  m_stages.emplace_back(stage_kind_t::divide, a_divisor);
+  return *this;
+}
+
+output_transform_t& output_transform_t::percent_deviation(double a_reference)
+{
+  m_stages.emplace_back(stage_kind_t::percent_deviation, a_reference);
+  return *this;
+}
+
+output_transform_t& output_transform_t::log10()
+{
+  m_stages.emplace_back(stage_kind_t::log10, 0);
+  return *this;
+}
+
+void output_transform_t::clear()
+{
+  m_stages.clear();
+}
+
+bool output_transform_t::empty() const
+{
+  return m_stages.empty();
+}
+
+void output_transform_t::apply(const double* a_x, double* a_y, std::size_t a_count) const
+{
+  //The stage is chosen once per buffer, the loops have no branches
+  //and are vectorized by the compiler
+  for (const stage_t& stage: m_stages) {
+    switch (stage.kind) {
+      case stage_kind_t::divide_by_x: {
+        for (std::size_t i = 0; i < a_count; i++) {
+          a_y[i] = a_y[i] / a_x[i];
+        }
+      } break;
+      case stage_kind_t::divide: {
+        //Division, not multiplication by the inverse, so that the values
+        //are the same as the ones divided point by point before
+        const double divisor = stage.value;
+        for (std::size_t i = 0; i < a_count; i++) {
+          a_y[i] = a_y[i] / divisor;
+        }
+      } break;
+      case stage_kind_t::percent_deviation: {
+        const double reference = stage.value;
+        for (std::size_t i = 0; i < a_count; i++) {
+          a_y[i] = (a_y[i] - reference) / reference * 100;
+        }
+      } break;
+      case stage_kind_t::log10: {
+        const double nan = std::numeric_limits<double>::quiet_NaN();
+        for (std::size_t i = 0; i < a_count; i++) {
+          a_y[i] = (a_y[i] > 0) ? std::log10(a_y[i]) : nan;
+        }
+      } break;
+    }
+  }
+}
+
+void output_transform_t::apply(const std::vector<double>& a_x, const std::vector<double>& a_src,
+  std::vector<double>& a_dst) const
+{
+  a_dst.assign(a_src.begin(), a_src.end());
+  apply(a_x.data(), a_dst.data(), a_dst.size());
+}
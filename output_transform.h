@@ -0,0 +1,55 @@
+#ifndef OUTPUT_TRANSFORM_H
+#define OUTPUT_TRANSFORM_H
+
+#include <cstddef>
+#include <vector>
+
+//Post-processing of drawn Y, configured once per redraw and applied to
+//whole sample buffers. Every stage is one branch-free loop over the buffer,
+//stages run in the order they were added
+class output_transform_t
+{
+public:
+  output_transform_t();
+
+  //y / x, relative values of a column. Not finite at x == 0
+  output_transform_t& divide_by_x();
+  //y / a_divisor, relative values of a row
+  output_transform_t& divide(double a_divisor);
+  //(y - a_reference) / a_reference * 100, like relative_deviation
+  output_transform_t& percent_deviation(double a_reference);
+  //log10(y), NaN for y <= 0. Not finite values are not stored in the
+  //chart series, MainWindow drops them before drawing
+  output_transform_t& log10();
+  void clear();
+  bool empty() const;
+
+  //Transforms a_y in place, a_x are X of the samples
+  void apply(const double* a_x, double* a_y, std::size_t a_count) const;
+  //Copies a_src to a_dst and transforms it
+  void apply(const std::vector<double>& a_x, const std::vector<double>& a_src,
+    std::vector<double>& a_dst) const;
+private:
+  enum class stage_kind_t {
+    divide_by_x,
+    divide,
+    percent_deviation,
+    log10
+  };
+
+  struct stage_t
+  {
+    stage_kind_t kind;
+    double value;
+
+    stage_t(stage_kind_t a_kind, double a_value):
+      kind(a_kind),
+      value(a_value)
+    {
+    }
+  };
+
+  std::vector<stage_t> m_stages;
+};
+
+#endif // OUTPUT_TRANSFORM_H
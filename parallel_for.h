@@ -0,0 +1,126 @@
+#ifndef PARALLEL_FOR_H
+#define PARALLEL_FOR_H
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//Number of threads for a_count items when each thread should get
+//at least a_min_per_thread of them, 0 a_max_threads means all cores
+inline std::size_t parallel_thread_count(std::size_t a_count, std::size_t a_min_per_thread,
+  std::size_t a_max_threads = 0)
+{
+  std::size_t thread_count = a_max_threads;
+  if (thread_count == 0) {
+    thread_count = std::max<std::size_t>(1, std::thread::hardware_concurrency());
+  }
+  return std::max<std::size_t>(1, std::min(thread_count, a_count / std::max<std::size_t>(1, a_min_per_thread)));
+}
+
+//Calls a_fn(thread_index, begin, end) for contiguous chunks of [0, a_count),
+//chunk 0 runs in the calling thread
+template <class F>
+void for_each_chunk(std::size_t a_count, std::size_t a_thread_count, F a_fn)
+{
+  std::vector<std::thread> threads;
+  threads.reserve(a_thread_count - 1);
+  const std::size_t chunk = (a_count + a_thread_count - 1) / a_thread_count;
+  for (std::size_t t = 1; t < a_thread_count; t++) {
+    std::size_t begin = std::min(a_count, t * chunk);
+    std::size_t end = std::min(a_count, begin + chunk);
+    threads.emplace_back(a_fn, t, begin, end);
+  }
+  a_fn(std::size_t(0), std::size_t(0), std::min(a_count, chunk));
+  for (auto& thread: threads) {
+    thread.join();
+  }
+}
+
+//Calls a_fn(thread_index, item) for every item of [0, a_count) when the items
+//take very different time. Every thread starts with an even share, a thread
+//that runs out steals the back half of the largest remaining share.
+//Share 0 runs in the calling thread
+template <class F>
+void for_each_stealing(std::size_t a_count, std::size_t a_thread_count, F a_fn)
+{
+  struct share_t
+  {
+    std::mutex mutex;
+    std::size_t begin;
+    std::size_t end;
+  };
+  std::vector<std::unique_ptr<share_t>> shares;
+  const std::size_t chunk = (a_count + a_thread_count - 1) / a_thread_count;
+  for (std::size_t t = 0; t < a_thread_count; t++) {
+    shares.emplace_back(new share_t());
+    shares[t]->begin = std::min(a_count, t * chunk);
+    shares[t]->end = std::min(a_count, shares[t]->begin + chunk);
+  }
+
+  auto take = [&shares](std::size_t a_thread, std::size_t& a_item) {
+    share_t& own = *shares[a_thread];
+    std::lock_guard<std::mutex> lock(own.mutex);
+    if (own.begin == own.end) {
+      return false;
+    }
+    a_item = own.begin++;
+    return true;
+  };
+  //Moves the back half of the largest share to a_thread, false if all are empty
+  auto steal = [&shares](std::size_t a_thread) {
+    for (;;) {
+      std::size_t victim = shares.size();
+      std::size_t largest = 0;
+      for (std::size_t t = 0; t < shares.size(); t++) {
+        std::lock_guard<std::mutex> lock(shares[t]->mutex);
+        if (shares[t]->end - shares[t]->begin > largest) {
+          largest = shares[t]->end - shares[t]->begin;
+          victim = t;
+        }
+      }
+      if (victim == shares.size()) {
+        return false;
+      }
+      std::size_t begin = 0;
+      std::size_t end = 0;
+      {
+        std::lock_guard<std::mutex> lock(shares[victim]->mutex);
+        share_t& other = *shares[victim];
+        if (other.begin == other.end) {
+          //Emptied while we were looking, try another one
+          continue;
+        }
+        begin = other.begin + (other.end - other.begin) / 2;
+        end = other.end;
+        other.end = begin;
+      }
+      std::lock_guard<std::mutex> lock(shares[a_thread]->mutex);
+      shares[a_thread]->begin = begin;
+      shares[a_thread]->end = end;
+      return true;
+    }
+  };
+  auto run = [&](std::size_t a_thread) {
+    std::size_t item = 0;
+    do {
+      while (take(a_thread, item)) {
+        a_fn(a_thread, item);
+      }
+    } while (steal(a_thread));
+  };
+
+  std::vector<std::thread> threads;
+  threads.reserve(a_thread_count - 1);
+  for (std::size_t t = 1; t < a_thread_count; t++) {
+    threads.emplace_back(run, t);
+  }
+  run(0);
+  for (auto& thread: threads) {
+    thread.join();
+  }
+}
+
+#endif // PARALLEL_FOR_H
@@ -0,0 +1,57 @@
+#ifndef PIECEWISE_CUBIC_H
+#define PIECEWISE_CUBIC_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+//Fitted curve in a flat form that does not depend on the interpolation type,
+//used to publish coefficients outside of the process.
+//For n knots there are n + 1 segments with 4 coefficients each,
+//f(x) = y + h*(c1 + h*(c2 + h*c3)), h = x - anchor:
+//  segment 0     - left extrapolation, anchor knots[0]
+//  segment i     - [knots[i-1], knots[i]], anchor knots[i-1]
+//  segment n     - right extrapolation, anchor knots[n-1]
+struct piecewise_cubic_t
+{
+  enum { coeffs_per_segment = 4 };
+
+  std::vector<double> knots;
+  std::vector<double> coeffs;
+  //Non-zero for periodic curves, x is wrapped into [knots[0], knots[0] + period)
+  double period;
+
+  piecewise_cubic_t():
+    knots(),
+    coeffs(),
+    period(0)
+  {
+  }
+};
+
+//Evaluation straight from the raw arrays, so that they can live in a shared mapping
+inline double piecewise_cubic_value(const double* a_knots, const double* a_coeffs,
+  std::size_t a_knot_count, double a_period, double a_x)
+{
+  if (a_period > 0) {
+    a_x = a_knots[0] + std::fmod(a_x - a_knots[0], a_period);
+    if (a_x < a_knots[0]) {
+      a_x += a_period;
+    }
+  }
+  const std::size_t segment = static_cast<std::size_t>(
+    std::upper_bound(a_knots, a_knots + a_knot_count, a_x) - a_knots);
+  const std::size_t anchor = (segment == 0) ? 0 : segment - 1;
+  const double* c = a_coeffs + segment * piecewise_cubic_t::coeffs_per_segment;
+  const double h = a_x - a_knots[anchor];
+  return c[0] + h * (c[1] + h * (c[2] + h * c[3]));
+}
+
+inline double piecewise_cubic_value(const piecewise_cubic_t& a_curve, double a_x)
+{
+  return piecewise_cubic_value(a_curve.knots.data(), a_curve.coeffs.data(),
+    a_curve.knots.size(), a_curve.period, a_x);
+}
+
+#endif // PIECEWISE_CUBIC_H
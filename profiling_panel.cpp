@@ -0,0 +1,259 @@
+#include "profiling_panel.h"
+
+#include <QGridLayout>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QPainter>
+#include <QPushButton>
+
+#include <algorithm>
+
+namespace {
+
+struct timer_sample_t
+{
+  instr_timer_t timer;
+  unsigned tag;
+  std::uint64_t ns;
+};
+
+//Samples come from the pool threads, the panel takes them in the GUI thread.
+//If the GUI does not take them for a long time the newest ones are dropped
+const std::size_t max_pending_samples = 16384;
+QMutex g_pending_mutex;
+std::vector<timer_sample_t> g_pending_samples;
+
+void collect_timer_sample(instr_timer_t a_timer, unsigned a_tag, std::uint64_t a_ns)
+{
+  QMutexLocker lock(&g_pending_mutex);
+  if (g_pending_samples.size() < max_pending_samples) {
+    g_pending_samples.push_back(timer_sample_t{ a_timer, a_tag, a_ns });
+  }
+}
+
+double ns_to_ms(std::uint64_t a_ns)
+{
+  return static_cast<double>(a_ns) / 1e6;
+}
+
+} // namespace
+
+histogram_view_t::histogram_view_t(QWidget *parent) :
+  QWidget(parent),
+  m_buckets()
+{
+}
+
+void histogram_view_t::set_buckets(std::vector<std::size_t> a_buckets)
+{
+  m_buckets = std::move(a_buckets);
+  update();
+}
+
+QSize histogram_view_t::sizeHint() const
+{
+  return QSize(120, 20);
+}
+
+void histogram_view_t::paintEvent(QPaintEvent*)
+{
+  QPainter painter(this);
+  painter.fillRect(rect(), palette().base());
+  if (m_buckets.empty()) {
+    return;
+  }
+  std::size_t max_count = *std::max_element(m_buckets.begin(), m_buckets.end());
+  if (max_count == 0) {
+    return;
+  }
+  double bar_width = static_cast<double>(width()) / m_buckets.size();
+  for (std::size_t i = 0; i < m_buckets.size(); i++) {
+    double bar_height = static_cast<double>(height()) * m_buckets[i] / max_count;
+    painter.fillRect(QRectF(i * bar_width, height() - bar_height, bar_width - 1, bar_height),
+      palette().highlight());
+  }
+}
+
+profiling_panel_t::profiling_panel_t(QWidget *parent) :
+  QWidget(parent, Qt::Tool),
+  m_histograms(row_count, rolling_histogram_t<double>(history_size)),
+  m_rows(row_count),
+  mp_status(new QLabel(this)),
+  m_update_timer(),
+  m_prev_snapshot(instr_snapshot())
+{
+  setWindowTitle("Profiling");
+
+  QGridLayout* layout = new QGridLayout(this);
+  const char* const headers[] = { "", "Last", "Median", "95%", "Max", "Histogram" };
+  for (int column = 0; column < 6; column++) {
+    layout->addWidget(new QLabel(headers[column], this), 0, column);
+  }
+  for (size_t type = 0; type < it_count; type++) {
+    QString name = interpolation_name(static_cast<interpolation_type_t>(type));
+    add_row(row_fit_first + static_cast<int>(type), name + " fit, ms");
+  }
+  for (size_t type = 0; type < it_count; type++) {
+    QString name = interpolation_name(static_cast<interpolation_type_t>(type));
+    add_row(row_sampling_first + static_cast<int>(type), name + " sampling, ms");
+  }
+  add_row(row_fit_job, "Fit job, ms");
+  add_row(row_redraw, "Redraw, ms");
+  add_row(row_rendered_points, "Points per redraw");
+  add_row(row_csv_mbytes, "CSV import, MB/s");
+  add_row(row_csv_rows, "CSV import, rows/s");
+
+  QPushButton* reset_button = new QPushButton("Reset", this);
+  connect(reset_button, &QPushButton::clicked, this, &profiling_panel_t::reset);
+  layout->addWidget(mp_status, row_count + 1, 0, 1, 5);
+  layout->addWidget(reset_button, row_count + 1, 5);
+  mp_status->setAutoFillBackground(true);
+
+  if (instr_enabled()) {
+    instr_set_sample_hook(&collect_timer_sample);
+    connect(&m_update_timer, &QTimer::timeout, this, &profiling_panel_t::update_statistics);
+    m_update_timer.start(update_period_ms);
+    mp_status->setText("No data yet");
+  } else {
+    mp_status->setText("Instrumentation is disabled, "
+      "uncomment DEFINES += SPLINES_INSTRUMENTATION in the .pro file");
+  }
+}
+
+profiling_panel_t::~profiling_panel_t()
+{
+  instr_set_sample_hook(nullptr);
+}
+
+void profiling_panel_t::add_row(int a_row, const QString& a_name)
+{
+  QGridLayout* grid = static_cast<QGridLayout*>(layout());
+  int grid_row = a_row + 1;
+  row_widgets_t& row = m_rows[a_row];
+  row.last = new QLabel(this);
+  row.median = new QLabel(this);
+  row.percentile_95 = new QLabel(this);
+  row.max = new QLabel(this);
+  row.histogram = new histogram_view_t(this);
+
+  grid->addWidget(new QLabel(a_name, this), grid_row, 0);
+  grid->addWidget(row.last, grid_row, 1);
+  grid->addWidget(row.median, grid_row, 2);
+  grid->addWidget(row.percentile_95, grid_row, 3);
+  grid->addWidget(row.max, grid_row, 4);
+  grid->addWidget(row.histogram, grid_row, 5);
+}
+
+void profiling_panel_t::show_row(int a_row)
+{
+  const rolling_histogram_t<double>& histogram = m_histograms[a_row];
+  row_widgets_t& row = m_rows[a_row];
+  if (histogram.empty()) {
+    row.last->setText("");
+    row.median->setText("");
+    row.percentile_95->setText("");
+    row.max->setText("");
+  } else {
+    row.last->setText(QString::number(histogram.last(), 'g', 4));
+    row.median->setText(QString::number(histogram.percentile(0.5), 'g', 4));
+    row.percentile_95->setText(QString::number(histogram.percentile(0.95), 'g', 4));
+    row.max->setText(QString::number(histogram.max(), 'g', 4));
+  }
+  row.histogram->set_buckets(histogram.buckets(bucket_count));
+}
+
+void profiling_panel_t::update_statistics()
+{
+  std::vector<timer_sample_t> samples;
+  {
+    QMutexLocker lock(&g_pending_mutex);
+    samples.swap(g_pending_samples);
+  }
+  instr_snapshot_t snapshot = instr_snapshot();
+
+  std::uint64_t redraw_count = 0;
+  std::uint64_t csv_ns = 0;
+  for (const timer_sample_t& sample: samples) {
+    switch (sample.timer) {
+      case itm_interp_fit: {
+        if (sample.tag < it_count) {
+          m_histograms[row_fit_first + sample.tag].add(ns_to_ms(sample.ns));
+        }
+      } break;
+      case itm_interp_sampling: {
+        if (sample.tag < it_count) {
+          m_histograms[row_sampling_first + sample.tag].add(ns_to_ms(sample.ns));
+        }
+      } break;
+      case itm_fit_job: {
+        m_histograms[row_fit_job].add(ns_to_ms(sample.ns));
+      } break;
+      case itm_redraw: {
+        m_histograms[row_redraw].add(ns_to_ms(sample.ns));
+        redraw_count++;
+      } break;
+      case itm_csv_import: {
+        csv_ns += sample.ns;
+      } break;
+      default: {
+      } break;
+    }
+  }
+
+  //Counters are not bound to a sample, so several redraws or imports
+  //in one update period are averaged
+  if (redraw_count > 0) {
+    std::uint64_t points = snapshot.counters[ic_rendered_points] -
+      m_prev_snapshot.counters[ic_rendered_points];
+    m_histograms[row_rendered_points].add(static_cast<double>(points) / redraw_count);
+  }
+  if (csv_ns > 0) {
+    double seconds = static_cast<double>(csv_ns) / 1e9;
+    std::uint64_t bytes = snapshot.counters[ic_csv_bytes] - m_prev_snapshot.counters[ic_csv_bytes];
+    std::uint64_t rows = snapshot.counters[ic_csv_rows] - m_prev_snapshot.counters[ic_csv_rows];
+    m_histograms[row_csv_mbytes].add(static_cast<double>(bytes) / 1e6 / seconds);
+    m_histograms[row_csv_rows].add(static_cast<double>(rows) / seconds);
+  }
+  m_prev_snapshot = snapshot;
+
+  if (samples.empty()) {
+    return;
+  }
+  for (int row = 0; row < row_count; row++) {
+    show_row(row);
+  }
+
+  if (!m_histograms[row_redraw].empty()) {
+    double latency = m_histograms[row_fit_job].percentile(0.95) +
+      m_histograms[row_redraw].percentile(0.95);
+    QString text = QString("95% of updates take %1 ms").arg(latency, 0, 'g', 4);
+    QPalette status_palette;
+    if (latency > interactive_budget_ms) {
+      text = "Too large for interactive use: " + text;
+      status_palette.setColor(QPalette::Window, QColor(0xfaa88e));
+    } else {
+      status_palette.setColor(QPalette::Window, QColor(0xbfffbd));
+    }
+    mp_status->setText(text);
+    mp_status->setPalette(status_palette);
+  }
+}
+
+void profiling_panel_t::reset()
+{
+  {
+    QMutexLocker lock(&g_pending_mutex);
+    g_pending_samples.clear();
+  }
+  for (auto& histogram: m_histograms) {
+    histogram.clear();
+  }
+  m_prev_snapshot = instr_snapshot();
+  for (int row = 0; row < row_count; row++) {
+    show_row(row);
+  }
+  mp_status->setPalette(QPalette());
+  if (instr_enabled()) {
+    mp_status->setText("No data yet");
+  }
+}
@@ -0,0 +1,90 @@
+#ifndef PROFILING_PANEL_H
+#define PROFILING_PANEL_H
+
+#include <QLabel>
+#include <QTimer>
+#include <QWidget>
+
+#include <cstdint>
+#include <vector>
+
+#include "instrumentation.h"
+#include "interpolation_factory.h"
+#include "rolling_histogram.h"
+
+//Bars of a rolling histogram
+class histogram_view_t : public QWidget
+{
+  Q_OBJECT
+
+public:
+  explicit histogram_view_t(QWidget *parent = nullptr);
+
+  void set_buckets(std::vector<std::size_t> a_buckets);
+  QSize sizeHint() const override;
+
+protected:
+  void paintEvent(QPaintEvent *a_event) override;
+
+private:
+  std::vector<std::size_t> m_buckets;
+};
+
+//Tool window with rolling statistics of the instrumented code:
+//fit and sampling time of every interpolation, redraw time,
+//points per redraw and CSV import throughput.
+//Timer samples are delivered by the instrumentation sample hook,
+//so the panel shows data only if SPLINES_INSTRUMENTATION is defined
+class profiling_panel_t : public QWidget
+{
+  Q_OBJECT
+
+public:
+  explicit profiling_panel_t(QWidget *parent = nullptr);
+  ~profiling_panel_t();
+
+private slots:
+  void update_statistics();
+  void reset();
+
+private:
+  enum {
+    //Number of samples in every histogram
+    history_size = 256,
+    bucket_count = 24,
+    update_period_ms = 250,
+    //Fit and redraw together must fit in this time for smooth W/A/S/D navigation
+    interactive_budget_ms = 100
+  };
+
+  enum row_t {
+    row_fit_first = 0,
+    row_sampling_first = row_fit_first + it_count,
+    row_fit_job = row_sampling_first + it_count,
+    row_redraw = row_fit_job + 1,
+    row_rendered_points = row_redraw + 1,
+    row_csv_mbytes = row_rendered_points + 1,
+    row_csv_rows = row_csv_mbytes + 1,
+    row_count = row_csv_rows + 1
+  };
+
+  struct row_widgets_t {
+    QLabel* last;
+    QLabel* median;
+    QLabel* percentile_95;
+    QLabel* max;
+    histogram_view_t* histogram;
+  };
+
+  std::vector<rolling_histogram_t<double>> m_histograms;
+  std::vector<row_widgets_t> m_rows;
+  QLabel* mp_status;
+  QTimer m_update_timer;
+  //Counters at the previous update, rates are calculated from the difference
+  instr_snapshot_t m_prev_snapshot;
+
+  void add_row(int a_row, const QString& a_name);
+  void show_row(int a_row);
+};
+
+#endif // PROFILING_PANEL_H
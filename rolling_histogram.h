@@ -0,0 +1,122 @@
+#ifndef ROLLING_HISTOGRAM_H
+#define ROLLING_HISTOGRAM_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+//Keeps the last a_capacity samples, older samples are overwritten.
+//Statistics are calculated on request, the container is meant for
+//a few hundred samples shown in the GUI
+template<typename T>
+class rolling_histogram_t
+{
+private:
+  std::vector<T> m_samples;
+  std::size_t m_capacity;
+  std::size_t m_next;
+public:
+  explicit rolling_histogram_t(std::size_t a_capacity = 256) :
+    m_samples(),
+    m_capacity(a_capacity),
+    m_next(0)
+  {
+    m_samples.reserve(m_capacity);
+  }
+  void add(T a_value);
+  void clear();
+  std::size_t size() const;
+  bool empty() const;
+  T last() const;
+  T max() const;
+  //a_fraction from 0 to 1, 0.5 is the median
+  T percentile(double a_fraction) const;
+  //Sample counts in a_bucket_count buckets of equal width between min and max
+  std::vector<std::size_t> buckets(std::size_t a_bucket_count) const;
+};
+
+template<typename T>
+void rolling_histogram_t<T>::add(T a_value)
+{
+  if (m_samples.size() < m_capacity) {
+    m_samples.push_back(a_value);
+  } else {
+    m_samples[m_next] = a_value;
+  }
+  m_next = (m_next + 1) % m_capacity;
+}
+
+template<typename T>
+void rolling_histogram_t<T>::clear()
+{
+  m_samples.clear();
+  m_next = 0;
+}
+
+template<typename T>
+std::size_t rolling_histogram_t<T>::size() const
+{
+  return m_samples.size();
+}
+
+template<typename T>
+bool rolling_histogram_t<T>::empty() const
+{
+  return m_samples.empty();
+}
+
+template<typename T>
+T rolling_histogram_t<T>::last() const
+{
+  if (m_samples.empty()) {
+    return T();
+  }
+  return m_samples[(m_next + m_capacity - 1) % m_capacity];
+}
+
+template<typename T>
+T rolling_histogram_t<T>::max() const
+{
+  if (m_samples.empty()) {
+    return T();
+  }
+  return *std::max_element(m_samples.begin(), m_samples.end());
+}
+
+template<typename T>
+T rolling_histogram_t<T>::percentile(double a_fraction) const
+{
+  if (m_samples.empty()) {
+    return T();
+  }
+  std::vector<T> sorted = m_samples;
+  std::size_t index = static_cast<std::size_t>(
+    std::lround(a_fraction * static_cast<double>(sorted.size() - 1)));
+  index = std::min(index, sorted.size() - 1);
+  std::nth_element(sorted.begin(), sorted.begin() + index, sorted.end());
+  return sorted[index];
+}
+
+template<typename T>
+std::vector<std::size_t> rolling_histogram_t<T>::buckets(std::size_t a_bucket_count) const
+{
+  std::vector<std::size_t> counts(a_bucket_count, 0);
+  if (m_samples.empty() || (a_bucket_count == 0)) {
+    return counts;
+  }
+  auto range = std::minmax_element(m_samples.begin(), m_samples.end());
+  double min = static_cast<double>(*range.first);
+  double width = static_cast<double>(*range.second) - min;
+  for (const T& sample: m_samples) {
+    std::size_t bucket = 0;
+    if (width > 0) {
+      bucket = static_cast<std::size_t>(
+        (static_cast<double>(sample) - min) / width * static_cast<double>(a_bucket_count));
+    }
+    counts[std::min(bucket, a_bucket_count - 1)]++;
+  }
+  return counts;
+}
+
+#endif // ROLLING_HISTOGRAM_H
@@ -0,0 +1,44 @@
+#ifndef SEGMENT_SEARCH_H
+#define SEGMENT_SEARCH_H
+
+#include "instrumentation.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <vector>
+
+//Index i of the interval [x[i], x[i+1]) that contains a_value.
+//Values outside of the knots map to the first/last interval
+template <class T, class A>
+std::size_t find_segment(const std::vector<T, A>& a_x, T a_value)
+{
+  assert(a_x.size() >= 2);
+  SPLINES_COUNT(ic_binary_searches);
+  auto it = std::upper_bound(a_x.begin() + 1, a_x.end() - 1, a_value);
+  return static_cast<std::size_t>(it - a_x.begin()) - 1;
+}
+
+//Same as find_segment, but checks a_hint and its right neighbour first.
+//For sorted batches (chart sampling) the search is almost always O(1)
+template <class T, class A>
+std::size_t find_segment(const std::vector<T, A>& a_x, T a_value, std::size_t a_hint)
+{
+  const std::size_t last = a_x.size() - 2;
+  if (a_hint <= last) {
+    bool after_left = (a_hint == 0) || (a_x[a_hint] <= a_value);
+    if (after_left) {
+      if ((a_hint == last) || (a_value < a_x[a_hint + 1])) {
+        SPLINES_COUNT(ic_hinted_searches);
+        return a_hint;
+      }
+      if ((a_hint + 1 == last) || (a_value < a_x[a_hint + 2])) {
+        SPLINES_COUNT(ic_hinted_searches);
+        return a_hint + 1;
+      }
+    }
+  }
+  return find_segment(a_x, a_value);
+}
+
+#endif // SEGMENT_SEARCH_H
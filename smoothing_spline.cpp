@@ -0,0 +1,264 @@
+#include "smoothing_spline.h"
+#include "segment_search.h"
+#include "instrumentation.h"
+
+#include <cmath>
+#include <limits>
+
+namespace tk {
+
+
+smoothing_spline::smoothing_spline(): m_lambda(0.0),
+    m_gcv(std::numeric_limits<double>::quiet_NaN())
+{
+}
+
+smoothing_spline::~smoothing_spline()
+{
+}
+
+void smoothing_spline::set_points(const double *a_x, const double *a_y, size_t a_size)
+{
+    SPLINES_SCOPED_TIMER(itm_set_points);
+    SPLINES_COUNT(ic_fits);
+    assert(a_size > 1);
+    m_x.assign(a_x, a_x + a_size);
+    m_y.assign(a_y, a_y + a_size);
+
+    int n=static_cast<int>(m_x.size());
+    for(int i=0; i<n-1; i++) {
+        assert(m_x[i]<m_x[i+1]);
+    }
+
+    // setting up the lambda independent parts, see
+    // Green, Silverman "Nonparametric regression and generalized linear models"
+    int m=std::max(n-2, 0);
+    m_q0.resize(m);
+    m_q1.resize(m);
+    m_q2.resize(m);
+    m_r0.resize(m);
+    m_r1.resize(m);
+    m_qty.resize(m);
+    for(int j=0; j<m; j++) {
+        double h0=m_x[j+1]-m_x[j];
+        double h1=m_x[j+2]-m_x[j+1];
+        m_q0[j]=1.0/h0;
+        m_q1[j]=-1.0/h0-1.0/h1;
+        m_q2[j]=1.0/h1;
+        m_r0[j]=(h0+h1)/3.0;
+        m_r1[j]=h1/6.0;
+        m_qty[j]=m_q0[j]*m_y[j] + m_q1[j]*m_y[j+1] + m_q2[j]*m_y[j+2];
+    }
+    m_qtq0.resize(m);
+    m_qtq1.resize(m);
+    m_qtq2.resize(m);
+    for(int j=0; j<m; j++) {
+        m_qtq0[j]=m_q0[j]*m_q0[j] + m_q1[j]*m_q1[j] + m_q2[j]*m_q2[j];
+        // columns j and j+1 share the rows j+1, j+2
+        m_qtq1[j]=(j+1<m) ? m_q1[j]*m_q0[j+1] + m_q2[j]*m_q1[j+1] : 0.0;
+        // columns j and j+2 share the row j+2
+        m_qtq2[j]=(j+2<m) ? m_q2[j]*m_q0[j+2] : 0.0;
+    }
+    if(m>0) {
+        m_system.resize(m,2,2);
+    }
+    fit();
+}
+
+void smoothing_spline::set_lambda(double lambda)
+{
+    assert(lambda>=0.0);
+    m_lambda=lambda;
+    if(m_x.size()>0) {
+        fit();
+    }
+}
+
+double smoothing_spline::lambda() const
+{
+    return m_lambda;
+}
+
+double smoothing_spline::gcv_score() const
+{
+    return m_gcv;
+}
+
+void smoothing_spline::fit()
+{
+    int n=static_cast<int>(m_x.size());
+    int m=n-2;
+    m_g=m_y;
+    m_gamma.assign(n, 0.0);
+
+    if(m>0) {
+        // (R + lambda*Q^T*Q) is symmetric pentadiagonal
+        for(int j=0; j<m; j++) {
+            m_system(j,j)=m_r0[j] + m_lambda*m_qtq0[j];
+            if(j+1<m) {
+                double v=m_r1[j] + m_lambda*m_qtq1[j];
+                m_system(j,j+1)=v;
+                m_system(j+1,j)=v;
+            }
+            if(j+2<m) {
+                double v=m_lambda*m_qtq2[j];
+                m_system(j,j+2)=v;
+                m_system(j+2,j)=v;
+            }
+        }
+        std::pmr::vector<double> gamma=m_system.lu_solve(m_qty);
+        std::copy(gamma.begin(), gamma.end(), m_gamma.begin()+1);
+
+        // g = y - lambda*Q*gamma
+        for(int j=0; j<m; j++) {
+            m_g[j]  -= m_lambda*m_q0[j]*gamma[j];
+            m_g[j+1]-= m_lambda*m_q1[j]*gamma[j];
+            m_g[j+2]-= m_lambda*m_q2[j]*gamma[j];
+        }
+    }
+
+    // piecewise cubic representation as in tk::spline
+    m_a.resize(n);
+    m_b.resize(n);
+    m_c.resize(n);
+    for(int i=0; i<n-1; i++) {
+        double h=m_x[i+1]-m_x[i];
+        m_a[i]=(m_gamma[i+1]-m_gamma[i])/(6.0*h);
+        m_b[i]=0.5*m_gamma[i];
+        m_c[i]=(m_g[i+1]-m_g[i])/h - h*(2.0*m_gamma[i]+m_gamma[i+1])/6.0;
+    }
+    // natural spline, linear extrapolation on both sides
+    double h=m_x[n-1]-m_x[n-2];
+    m_a[n-1]=0.0;
+    m_b[n-1]=0.0;
+    m_c[n-1]=3.0*m_a[n-2]*h*h+2.0*m_b[n-2]*h+m_c[n-2];
+
+    // gcv score V = n*RSS / (n - tr(A))^2, where I - A = lambda*Q*M^-1*Q^T,
+    // so only the central band of M^-1 is needed. It is calculated from
+    // the LU factors left in m_system (Hutchinson, de Hoog 1985)
+    double rss=0.0;
+    for(int i=0; i<n; i++) {
+        rss+=(m_y[i]-m_g[i])*(m_y[i]-m_g[i]);
+    }
+    double trace_i_a=0.0;
+    if(m>0 && m_lambda>0.0) {
+        // band_matrix stores L*U of the row scaled matrix S*M with
+        // S=diag(saved_diag), that gives M = L'*D*L'^T with
+        // L'(i,k) = L(i,k)*s_k/s_i and D_i = U(i,i)/s_i
+        std::vector<double> d(m), l1(m, 0.0), l2(m, 0.0);
+        for(int i=0; i<m; i++) {
+            double s=m_system.saved_diag(i);
+            d[i]=m_system(i,i)/s;
+            if(i+1<m) l1[i]=m_system(i+1,i)*s/m_system.saved_diag(i+1);
+            if(i+2<m) l2[i]=m_system(i+2,i)*s/m_system.saved_diag(i+2);
+        }
+        double b00=0.0, b01=0.0, b11=0.0;   // B(i+1,i+1), B(i+1,i+2), B(i+2,i+2)
+        for(int i=m-1; i>=0; i--) {
+            double bi2=-l1[i]*b01 - l2[i]*b11;
+            double bi1=-l1[i]*b00 - l2[i]*b01;
+            double bii=1.0/d[i] - l1[i]*bi1 - l2[i]*bi2;
+            trace_i_a+=bii*m_qtq0[i] + 2.0*bi1*m_qtq1[i] + 2.0*bi2*m_qtq2[i];
+            b11=b00;
+            b01=bi1;
+            b00=bii;
+        }
+        trace_i_a*=m_lambda;
+    }
+    double denom=trace_i_a/n;
+    m_gcv=(denom>0.0) ? (rss/n)/(denom*denom) : std::numeric_limits<double>::infinity();
+}
+
+void smoothing_spline::gcv_sweep(const double* lambdas, double* scores, size_t count)
+{
+    double saved_lambda=m_lambda;
+    for(size_t i=0; i<count; i++) {
+        set_lambda(lambdas[i]);
+        scores[i]=m_gcv;
+    }
+    set_lambda(saved_lambda);
+}
+
+double smoothing_spline::fit_gcv(double lambda_min, double lambda_max, int count)
+{
+    assert(lambda_min>0.0 && lambda_max>=lambda_min && count>0);
+    double best_lambda=lambda_min;
+    double best_score=std::numeric_limits<double>::infinity();
+    double log_step=(count>1) ? std::log(lambda_max/lambda_min)/(count-1) : 0.0;
+    for(int i=0; i<count; i++) {
+        double lambda=lambda_min*std::exp(log_step*i);
+        set_lambda(lambda);
+        if(m_gcv<best_score) {
+            best_score=m_gcv;
+            best_lambda=lambda;
+        }
+    }
+    set_lambda(best_lambda);
+    return best_lambda;
+}
+
+double smoothing_spline::calc_segment(size_t idx, double x) const
+{
+    size_t n=m_x.size();
+    if(x<m_x[0]) {
+        return m_g[0] + m_c[0]*(x-m_x[0]);
+    } else if(x>m_x[n-1]) {
+        return m_g[n-1] + m_c[n-1]*(x-m_x[n-1]);
+    }
+    double h=x-m_x[idx];
+    return ((m_a[idx]*h + m_b[idx])*h + m_c[idx])*h + m_g[idx];
+}
+
+double smoothing_spline::operator() (double x)
+{
+    return calc_segment(find_segment(m_x, x), x);
+}
+
+void smoothing_spline::calc_array(const double* a_x, double* a_y, size_t a_count)
+{
+    size_t idx=0;
+    for(size_t i=0; i<a_count; i++) {
+        idx=find_segment(m_x, a_x[i], idx);
+        a_y[i]=calc_segment(idx, a_x[i]);
+    }
+}
+
+interpolation_derivs_t smoothing_spline::calc_segment_derivs(size_t idx, double x) const
+{
+    size_t n=m_x.size();
+    interpolation_derivs_t derivs;
+    if(x<m_x[0] || x>m_x[n-1]) {
+        // linear extrapolation
+        size_t end=(x<m_x[0]) ? 0 : n-1;
+        derivs.value=m_g[end] + m_c[end]*(x-m_x[end]);
+        derivs.first=m_c[end];
+        derivs.second=0.0;
+        return derivs;
+    }
+    double h=x-m_x[idx];
+    derivs.value=((m_a[idx]*h + m_b[idx])*h + m_c[idx])*h + m_g[idx];
+    derivs.first=(3.0*m_a[idx]*h + 2.0*m_b[idx])*h + m_c[idx];
+    derivs.second=6.0*m_a[idx]*h + 2.0*m_b[idx];
+    return derivs;
+}
+
+interpolation_derivs_t smoothing_spline::calc_derivs(double x)
+{
+    return calc_segment_derivs(find_segment(m_x, x), x);
+}
+
+void smoothing_spline::calc_derivs_array(const double* a_x, double* a_value,
+                                         double* a_first, double* a_second,
+                                         size_t a_count)
+{
+    size_t idx=0;
+    for(size_t i=0; i<a_count; i++) {
+        idx=find_segment(m_x, a_x[i], idx);
+        interpolation_derivs_t derivs=calc_segment_derivs(idx, a_x[i]);
+        a_value[i]=derivs.value;
+        a_first[i]=derivs.first;
+        a_second[i]=derivs.second;
+    }
+}
+
+
+} // namespace tk
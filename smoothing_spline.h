@@ -0,0 +1,73 @@
+/*
+ * smoothing_spline.h
+ *
+ * cubic smoothing spline (Reinsch algorithm), minimises
+ *   sum (y_i - f(x_i))^2 + lambda * integral f''(x)^2 dx
+ * using the band_matrix solver from spline.h
+ *
+ */
+
+
+#ifndef TK_SMOOTHING_SPLINE_H
+#define TK_SMOOTHING_SPLINE_H
+
+#include "spline.h"
+
+#include <vector>
+
+
+namespace tk
+{
+
+// smoothing spline, lambda=0 gives the natural cubic interpolating spline,
+// lambda -> infinity gives the least squares straight line
+class smoothing_spline : public interpolation_base_t
+{
+private:
+    std::vector<double> m_x,m_y;            // input points
+    // f(x) = a*(x-x_i)^3 + b*(x-x_i)^2 + c*(x-x_i) + g_i
+    std::vector<double> m_g;                // smoothed values in the knots
+    std::vector<double> m_a,m_b,m_c;        // spline coefficients
+    std::vector<double> m_gamma;            // f'' in the knots
+    double  m_lambda;
+    double  m_gcv;
+
+    // lambda independent parts of (R + lambda*Q^T*Q)*gamma = Q^T*y,
+    // calculated once in set_points(), index j is the inner knot j+1
+    std::vector<double> m_q0,m_q1,m_q2;     // column j of Q in rows j..j+2
+    std::vector<double> m_r0,m_r1;          // diagonal and 1st band of R
+    std::vector<double> m_qtq0,m_qtq1,m_qtq2; // diagonal and bands of Q^T*Q
+    std::pmr::vector<double> m_qty;         // Q^T*y
+    band_matrix m_system;                   // reused for every lambda
+
+    void fit();
+    double calc_segment(size_t idx, double x) const;
+    interpolation_derivs_t calc_segment_derivs(size_t idx, double x) const;
+
+public:
+    smoothing_spline();
+    virtual ~smoothing_spline() override;
+    virtual void set_points(const double* a_x, const double* a_y, size_t a_size) override;
+    virtual double operator() (double x) override;
+    virtual void calc_array(const double* a_x, double* a_y, size_t a_count) override;
+    virtual interpolation_derivs_t calc_derivs(double x) override;
+    virtual void calc_derivs_array(const double* a_x, double* a_value,
+                                   double* a_first, double* a_second,
+                                   size_t a_count) override;
+
+    // optional before set_points(), afterwards refits in O(n)
+    void set_lambda(double lambda);
+    double lambda() const;
+    // generalized cross validation score of the current fit, smaller is better
+    double gcv_score() const;
+    // scores for many lambdas, the current lambda is restored afterwards
+    void gcv_sweep(const double* lambdas, double* scores, size_t count);
+    // tries count lambdas on a log scale in [lambda_min, lambda_max],
+    // keeps the one with the best gcv score and returns it
+    double fit_gcv(double lambda_min, double lambda_max, int count);
+};
+
+
+} // namespace tk
+
+#endif /* TK_SMOOTHING_SPLINE_H */
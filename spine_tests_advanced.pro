@@ -22,30 +22,84 @@ DEFINES += QT_DEPRECATED_WARNINGS
 # You can also select to disable deprecated APIs only up to a certain version of Qt.
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
 
-CONFIG += c++11
+# Counters and timers of the interpolation hot paths, see instrumentation.h.
+# Without this define the instrumentation macros compile to nothing.
+#DEFINES += SPLINES_INSTRUMENTATION
+
+CONFIG += c++17
 
 SOURCES += \
+        bspline_fit.cpp \
+        curve_compression.cpp \
+        curve_snapshot.cpp \
+        fit_pipeline.cpp \
+        fit_worker.cpp \
         import_points.cpp \
         import_points_dialog.cpp \
+        input_normalization.cpp \
+        instrumentation.cpp \
+        interpolation_factory.cpp \
+        knot_subset.cpp \
+        m4_pyramid.cpp \
         main.cpp \
         mainwindow.cpp \
-        spline.cpp
+        output_transform.cpp \
+        profiling_panel.cpp \
+        smoothing_spline.cpp \
+        spline.cpp \
+        spline_family.cpp \
+        stream_evaluation.cpp \
+        surface_interp.cpp \
+        table_fit.cpp \
+        table_reader.cpp
 
 HEADERS += \
+        akima.h \
+        bspline_fit.h \
+        cubic_eval.h \
+        curve_compression.h \
+        curve_snapshot.h \
+        fit_pipeline.h \
+        fit_worker.h \
         hermit.h \
         import_points.h \
         import_points_dialog.h \
+        input_normalization.h \
+        instrumentation.h \
         interpolation_base.h \
+        interpolation_factory.h \
+        inverse_search.h \
+        knot_subset.h \
         linear_interpolation.hpp \
         linear_interpolation.hpp \
+        m4_pyramid.h \
         mainwindow.h \
+        output_transform.h \
+        parallel_for.h \
         peak_searcher.h \
-        spline.h
+        piecewise_cubic.h \
+        profiling_panel.h \
+        rolling_histogram.h \
+        segment_search.h \
+        smoothing_spline.h \
+        spline.h \
+        spline_family.h \
+        stream_evaluation.h \
+        surface_interp.h \
+        table_fit.h \
+        table_reader.h
 
 FORMS += \
         import_points_form.ui \
         mainwindow.ui
 
+# Shared memory curve registry is POSIX only
+unix {
+    SOURCES += curve_registry.cpp
+    HEADERS += curve_registry.h
+    !macx: LIBS += -lrt
+}
+
 # Default rules for deployment.
 qnx: target.path = /tmp/$${TARGET}/bin
 else: unix:!android: target.path = /opt/$${TARGET}/bin
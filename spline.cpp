@@ -1,5 +1,9 @@
 #include "spline.h"
+#include "segment_search.h"
+#include "instrumentation.h"
+#include <cmath>
 #include <iterator>
+#include <limits>
 
 namespace tk {
 
@@ -7,7 +11,13 @@ namespace tk {
 // band_matrix implementation
 // -------------------------
 
-band_matrix::band_matrix(int dim, int n_u, int n_l)
+band_matrix::band_matrix(std::pmr::memory_resource* resource):
+    m_upper(resource), m_lower(resource)
+{
+}
+band_matrix::band_matrix(int dim, int n_u, int n_l,
+                         std::pmr::memory_resource* resource):
+    m_upper(resource), m_lower(resource)
 {
     resize(dim, n_u, n_l);
 }
@@ -25,6 +35,10 @@ void band_matrix::resize(int dim, int n_u, int n_l)
         m_lower[i].resize(dim);
     }
 }
+std::pmr::memory_resource* band_matrix::resource() const
+{
+    return m_upper.get_allocator().resource();
+}
 int band_matrix::dim() const
 {
     if(m_upper.size()>0) {
@@ -102,48 +116,125 @@ void band_matrix::lu_decompose()
         }
     }
 }
+namespace {
+
+// the solvers work on vectors with any allocator, x comes sized
+// from the caller with the allocator of the result
+
 // solves Ly=b
-std::vector<double> band_matrix::l_solve(const std::vector<double>& b) const
+template <class V>
+void l_solve_into(const band_matrix& A, const V& b, V& x)
 {
-    assert( this->dim()==static_cast<int>(b.size()));
-    std::vector<double> x(this->dim());
+    assert( A.dim()==static_cast<int>(b.size()));
     int j_start;
     double sum;
-    for(int i=0; i<this->dim(); i++) {
+    for(int i=0; i<A.dim(); i++) {
         sum=0;
-        j_start=std::max(0,i-this->num_lower());
-        for(int j=j_start; j<i; j++) sum += this->operator()(i,j)*x[j];
-        x[i]=(b[i]*this->saved_diag(i)) - sum;
+        j_start=std::max(0,i-A.num_lower());
+        for(int j=j_start; j<i; j++) sum += A(i,j)*x[j];
+        x[i]=(b[i]*A.saved_diag(i)) - sum;
     }
-    return x;
 }
 // solves Rx=y
-std::vector<double> band_matrix::r_solve(const std::vector<double>& b) const
+template <class V>
+void r_solve_into(const band_matrix& A, const V& b, V& x)
 {
-    assert( this->dim()==static_cast<int>(b.size()));
-    std::vector<double> x(this->dim());
+    assert( A.dim()==static_cast<int>(b.size()));
     int j_stop;
     double sum;
-    for(int i=this->dim()-1; i>=0; i--) {
+    for(int i=A.dim()-1; i>=0; i--) {
         sum=0;
-        j_stop=std::min(this->dim()-1,i+this->num_upper());
-        for(int j=i+1; j<=j_stop; j++) sum += this->operator()(i,j)*x[j];
-        x[i]=( b[i] - sum ) / this->operator()(i,i);
+        j_stop=std::min(A.dim()-1,i+A.num_upper());
+        for(int j=i+1; j<=j_stop; j++) sum += A(i,j)*x[j];
+        x[i]=( b[i] - sum ) / A(i,i);
+    }
+}
+
+// Sherman-Morrison: the cyclic matrix is written as A' + u*v^T with
+// u=(gamma,0,...,0,alpha), v=(1,0,...,0,beta/gamma), so two solves with
+// the tridiagonal A' are needed, but only one LU decomposition.
+// u comes with n zeros and the allocator of the result
+template <class V>
+V cyclic_solve_impl(band_matrix& A, double alpha, double beta, const V& rhs, V u)
+{
+    int n=A.dim();
+    assert(n>2);
+    assert(A.num_upper()>=1 && A.num_lower()>=1);
+    assert(n==static_cast<int>(rhs.size()));
+    assert(n==static_cast<int>(u.size()));
+
+    double gamma=-A(0,0);
+    A(0,0)-=gamma;
+    A(n-1,n-1)-=alpha*beta/gamma;
+    V x=A.lu_solve(rhs);
+
+    u[0]=gamma;
+    u[n-1]=alpha;
+    V z=A.lu_solve(u,true);
+
+    double fact=(x[0]+beta*x[n-1]/gamma)/(1.0+z[0]+beta*z[n-1]/gamma);
+    for(int i=0; i<n; i++) {
+        x[i]-=fact*z[i];
     }
     return x;
 }
 
+} // namespace
+
+std::pmr::vector<double> band_matrix::l_solve(const std::pmr::vector<double>& b) const
+{
+    std::pmr::vector<double> x(this->dim(), resource());
+    l_solve_into(*this, b, x);
+    return x;
+}
+std::vector<double> band_matrix::l_solve(const std::vector<double>& b) const
+{
+    std::vector<double> x(this->dim());
+    l_solve_into(*this, b, x);
+    return x;
+}
+std::pmr::vector<double> band_matrix::r_solve(const std::pmr::vector<double>& b) const
+{
+    std::pmr::vector<double> x(this->dim(), resource());
+    r_solve_into(*this, b, x);
+    return x;
+}
+std::vector<double> band_matrix::r_solve(const std::vector<double>& b) const
+{
+    std::vector<double> x(this->dim());
+    r_solve_into(*this, b, x);
+    return x;
+}
+
+std::pmr::vector<double> band_matrix::lu_solve(const std::pmr::vector<double>& b,
+        bool is_lu_decomposed)
+{
+    assert( this->dim()==static_cast<int>(b.size()));
+    if(is_lu_decomposed==false) {
+        this->lu_decompose();
+    }
+    return this->r_solve(this->l_solve(b));
+}
 std::vector<double> band_matrix::lu_solve(const std::vector<double>& b,
         bool is_lu_decomposed)
 {
     assert( this->dim()==static_cast<int>(b.size()));
-    std::vector<double>  x,y;
     if(is_lu_decomposed==false) {
         this->lu_decompose();
     }
-    y=this->l_solve(b);
-    x=this->r_solve(y);
-    return x;
+    return this->r_solve(this->l_solve(b));
+}
+
+std::pmr::vector<double> cyclic_solve(band_matrix& A, double alpha, double beta,
+                                      const std::pmr::vector<double>& rhs)
+{
+    return cyclic_solve_impl(A, alpha, beta, rhs,
+                             std::pmr::vector<double>(A.dim(), 0.0, A.resource()));
+}
+std::vector<double> cyclic_solve(band_matrix& A, double alpha, double beta,
+                                 const std::vector<double>& rhs)
+{
+    return cyclic_solve_impl(A, alpha, beta, rhs, std::vector<double>(A.dim(), 0.0));
 }
 
 
@@ -152,8 +243,15 @@ std::vector<double> band_matrix::lu_solve(const std::vector<double>& b,
 // spline implementation
 // -----------------------
 
-spline::spline(): m_left(second_deriv), m_right(second_deriv), m_left_value(0.0), m_right_value(0.0),
-    m_force_linear_extrapolation(false)
+spline::spline(): spline(std::pmr::get_default_resource())
+{
+}
+
+spline::spline(std::pmr::memory_resource* resource):
+    m_x(resource), m_y(resource), m_a(resource), m_b(resource), m_c(resource),
+    m_b0(0.0), m_c0(0.0), m_left(second_deriv), m_right(second_deriv),
+    m_left_value(0.0), m_right_value(0.0), m_force_linear_extrapolation(false),
+    m_inverse_index(resource), m_integral(resource)
 {
 }
 
@@ -174,8 +272,167 @@ void spline::set_boundary(spline::bd_type left, double left_value,
 }
 
 
+// calculate parameters a[] and c[] based on b[]
+void spline::set_a_c_from_b()
+{
+    int n=static_cast<int>(m_x.size());
+    m_a.resize(n);
+    m_c.resize(n);
+    for(int i=0; i<n-1; i++) {
+        m_a[i]=1.0/3.0*(m_b[i+1]-m_b[i])/(m_x[i+1]-m_x[i]);
+        m_c[i]=(m_y[i+1]-m_y[i])/(m_x[i+1]-m_x[i])
+               - 1.0/3.0*(2.0*m_b[i]+m_b[i+1])*(m_x[i+1]-m_x[i]);
+    }
+}
+
+void spline::set_coeffs()
+{
+    int n=static_cast<int>(m_x.size());
+    const std::pmr::vector<double>& x=m_x;
+    const std::pmr::vector<double>& y=m_y;
+
+    // not-a-knot needs a third point, with two points it is a straight line
+    bd_type left=(m_left==spline::not_a_knot && n<3) ? spline::second_deriv : m_left;
+    bd_type right=(m_right==spline::not_a_knot && n<3) ? spline::second_deriv : m_right;
+    double left_value=(left==m_left) ? m_left_value : 0.0;
+    double right_value=(right==m_right) ? m_right_value : 0.0;
+
+    // setting up the matrix and right hand side of the equation system
+    // for the parameters b[], not-a-knot rows reach one more column
+    int bands=(left==spline::not_a_knot || right==spline::not_a_knot) ? 2 : 1;
+    std::pmr::memory_resource* resource=m_x.get_allocator().resource();
+    band_matrix A(n,bands,bands,resource);
+    std::pmr::vector<double>  rhs(n,resource);
+    for(int i=1; i<n-1; i++) {
+        A(i,i-1)=1.0/3.0*(x[i]-x[i-1]);
+        A(i,i)=2.0/3.0*(x[i+1]-x[i-1]);
+        A(i,i+1)=1.0/3.0*(x[i+1]-x[i]);
+        rhs[i]=(y[i+1]-y[i])/(x[i+1]-x[i]) - (y[i]-y[i-1])/(x[i]-x[i-1]);
+    }
+    // boundary conditions
+    if(left == spline::second_deriv) {
+        // 2*b[0] = f''
+        A(0,0)=2.0;
+        A(0,1)=0.0;
+        rhs[0]=left_value;
+    } else if(left == spline::first_deriv) {
+        // c[0] = f', needs to be re-expressed in terms of b:
+        // (2b[0]+b[1])(x[1]-x[0]) = 3 ((y[1]-y[0])/(x[1]-x[0]) - f')
+        A(0,0)=2.0*(x[1]-x[0]);
+        A(0,1)=1.0*(x[1]-x[0]);
+        rhs[0]=3.0*((y[1]-y[0])/(x[1]-x[0])-left_value);
+    } else if(left == spline::not_a_knot && n==3 && right == spline::not_a_knot) {
+        // both conditions give the same equation, the result is a parabola
+        A(0,0)=1.0;
+        A(0,1)=-1.0;
+        rhs[0]=0.0;
+    } else if(left == spline::not_a_knot) {
+        // f''' is continuous in x[1]: a[0]=a[1], in terms of b:
+        // h1*b[0] - (h0+h1)*b[1] + h0*b[2] = 0
+        double h0=x[1]-x[0];
+        double h1=x[2]-x[1];
+        A(0,0)=h1;
+        A(0,1)=-(h0+h1);
+        A(0,2)=h0;
+        rhs[0]=0.0;
+    } else {
+        assert(false);
+    }
+    if(right == spline::second_deriv) {
+        // 2*b[n-1] = f''
+        A(n-1,n-1)=2.0;
+        A(n-1,n-2)=0.0;
+        rhs[n-1]=right_value;
+    } else if(right == spline::first_deriv) {
+        // c[n-1] = f', needs to be re-expressed in terms of b:
+        // (b[n-2]+2b[n-1])(x[n-1]-x[n-2])
+        // = 3 (f' - (y[n-1]-y[n-2])/(x[n-1]-x[n-2]))
+        A(n-1,n-1)=2.0*(x[n-1]-x[n-2]);
+        A(n-1,n-2)=1.0*(x[n-1]-x[n-2]);
+        rhs[n-1]=3.0*(right_value-(y[n-1]-y[n-2])/(x[n-1]-x[n-2]));
+    } else if(right == spline::not_a_knot && n==3 && left == spline::not_a_knot) {
+        A(n-1,n-1)=1.0;
+        A(n-1,n-2)=-1.0;
+        rhs[n-1]=0.0;
+    } else if(right == spline::not_a_knot) {
+        // a[n-3]=a[n-2]:
+        // h[n-2]*b[n-3] - (h[n-3]+h[n-2])*b[n-2] + h[n-3]*b[n-1] = 0
+        double h0=x[n-2]-x[n-3];
+        double h1=x[n-1]-x[n-2];
+        A(n-1,n-3)=h1;
+        A(n-1,n-2)=-(h0+h1);
+        A(n-1,n-1)=h0;
+        rhs[n-1]=0.0;
+    } else {
+        assert(false);
+    }
+
+    // solve the equation system to obtain the parameters b[]
+    m_b=A.lu_solve(rhs);
+    set_a_c_from_b();
+}
+
+void spline::set_periodic_coeffs()
+{
+    int n=static_cast<int>(m_x.size());
+    // unknowns b[0]..b[m-1], b[n-1]=b[0], indices of h and slopes wrap around
+    int m=n-1;
+    std::pmr::memory_resource* resource=m_x.get_allocator().resource();
+    std::pmr::vector<double> h(m,resource), slope(m,resource);
+    for(int i=0; i<m; i++) {
+        h[i]=m_x[i+1]-m_x[i];
+        slope[i]=(m_y[i+1]-m_y[i])/h[i];
+    }
+
+    std::pmr::vector<double> b(resource);
+    if(m==1) {
+        // y[0]=y[1], constant function
+        b.assign(1, 0.0);
+    } else {
+        band_matrix A(m,1,1,resource);
+        std::pmr::vector<double> rhs(m,resource);
+        for(int i=0; i<m; i++) {
+            int prev=(i+m-1)%m;
+            A(i,i)=2.0/3.0*(h[prev]+h[i]);
+            rhs[i]=slope[i]-slope[prev];
+        }
+        if(m==2) {
+            // the corners fall on the off-diagonals
+            A(0,1)=1.0/3.0*(h[0]+h[1]);
+            A(1,0)=1.0/3.0*(h[0]+h[1]);
+            b=A.lu_solve(rhs);
+        } else {
+            for(int i=0; i<m-1; i++) {
+                A(i,i+1)=1.0/3.0*h[i];
+                A(i+1,i)=1.0/3.0*h[i];
+            }
+            double corner=1.0/3.0*h[m-1];
+            b=cyclic_solve(A, corner, corner, rhs);
+        }
+    }
+    m_b.resize(n);
+    std::copy(b.begin(), b.end(), m_b.begin());
+    m_b[n-1]=m_b[0];
+    set_a_c_from_b();
+}
+
+double spline::periodic_wrap(double x) const
+{
+    double x0=m_x.front();
+    double period=m_x.back()-x0;
+    if(x<x0 || x>=x0+period) {
+        x=x0+std::fmod(x-x0, period);
+        if(x<x0) {
+            x+=period;
+        }
+    }
+    return x;
+}
+
 void spline::set_points(const double *a_x, const double *a_y, size_t a_size)
 {
+    SPLINES_SCOPED_TIMER(itm_set_points);
+    SPLINES_COUNT(ic_fits);
     assert(a_size > 1);
     m_x.clear();
     m_x.reserve(a_size);
@@ -186,73 +443,18 @@ void spline::set_points(const double *a_x, const double *a_y, size_t a_size)
     std::copy(a_y, a_y + a_size, std::back_inserter(m_y));
 
     int n=static_cast<int>(m_x.size());
-    // TODO: maybe sort x and y, rather than returning an error
+    // unsorted input goes through set_unordered_points()
     for(int i=0; i<n-1; i++) {
         assert(m_x[i]<m_x[i+1]);
     }
-    bool cubic_spline = true;
-    if(cubic_spline==true) { // cubic spline interpolation
-        // setting up the matrix and right hand side of the equation system
-        // for the parameters b[]
-        band_matrix A(n,1,1);
-        std::vector<double>  rhs(n);
-        for(int i=1; i<n-1; i++) {
-            A(i,i-1)=1.0/3.0*(a_x[i]-a_x[i-1]);
-            A(i,i)=2.0/3.0*(a_x[i+1]-a_x[i-1]);
-            A(i,i+1)=1.0/3.0*(a_x[i+1]-a_x[i]);
-            rhs[i]=(a_y[i+1]-a_y[i])/(a_x[i+1]-a_x[i]) - (a_y[i]-a_y[i-1])/(a_x[i]-a_x[i-1]);
-        }
-        // boundary conditions
-        if(m_left == spline::second_deriv) {
-            // 2*b[0] = f''
-            A(0,0)=2.0;
-            A(0,1)=0.0;
-            rhs[0]=m_left_value;
-        } else if(m_left == spline::first_deriv) {
-            // c[0] = f', needs to be re-expressed in terms of b:
-            // (2b[0]+b[1])(x[1]-x[0]) = 3 ((y[1]-y[0])/(x[1]-x[0]) - f')
-            A(0,0)=2.0*(a_x[1]-a_x[0]);
-            A(0,1)=1.0*(a_x[1]-a_x[0]);
-            rhs[0]=3.0*((a_y[1]-a_y[0])/(a_x[1]-a_x[0])-m_left_value);
-        } else {
-            assert(false);
-        }
-        if(m_right == spline::second_deriv) {
-            // 2*b[n-1] = f''
-            A(n-1,n-1)=2.0;
-            A(n-1,n-2)=0.0;
-            rhs[n-1]=m_right_value;
-        } else if(m_right == spline::first_deriv) {
-            // c[n-1] = f', needs to be re-expressed in terms of b:
-            // (b[n-2]+2b[n-1])(x[n-1]-x[n-2])
-            // = 3 (f' - (y[n-1]-y[n-2])/(x[n-1]-x[n-2]))
-            A(n-1,n-1)=2.0*(a_x[n-1]-a_x[n-2]);
-            A(n-1,n-2)=1.0*(a_x[n-1]-a_x[n-2]);
-            rhs[n-1]=3.0*(m_right_value-(a_y[n-1]-a_y[n-2])/(a_x[n-1]-a_x[n-2]));
-        } else {
-            assert(false);
-        }
-
-        // solve the equation system to obtain the parameters b[]
-        m_b=A.lu_solve(rhs);
-
-        // calculate parameters a[] and c[] based on b[]
-        m_a.resize(n);
-        m_c.resize(n);
-        for(int i=0; i<n-1; i++) {
-            m_a[i]=1.0/3.0*(m_b[i+1]-m_b[i])/(a_x[i+1]-a_x[i]);
-            m_c[i]=(a_y[i+1]-a_y[i])/(a_x[i+1]-a_x[i])
-                   - 1.0/3.0*(2.0*m_b[i]+m_b[i+1])*(a_x[i+1]-a_x[i]);
-        }
-    } else { // linear interpolation
-        m_a.resize(n);
-        m_b.resize(n);
-        m_c.resize(n);
-        for(int i=0; i<n-1; i++) {
-            m_a[i]=0.0;
-            m_b[i]=0.0;
-            m_c[i]=(m_y[i+1]-m_y[i])/(m_x[i+1]-m_x[i]);
-        }
+    if(m_left == spline::periodic) {
+        // f, f' and f'' of both ends must match, b[n-1]=b[0]
+        assert(m_right == spline::periodic);
+        m_y[n-1]=m_y[0];
+        set_periodic_coeffs();
+    } else {
+        assert(m_right != spline::periodic);
+        set_coeffs();
     }
 
     // for left extrapolation coefficients
@@ -261,29 +463,123 @@ void spline::set_points(const double *a_x, const double *a_y, size_t a_size)
 
     // for the right extrapolation coefficients
     // f_{n-1}(x) = b*(x-x_{n-1})^2 + c*(x-x_{n-1}) + y_{n-1}
-    double h=a_x[n-1]-a_x[n-2];
+    double h=m_x[n-1]-m_x[n-2];
     // m_b[n-1] is determined by the boundary condition
     m_a[n-1]=0.0;
     m_c[n-1]=3.0*m_a[n-2]*h*h+2.0*m_b[n-2]*h+m_c[n-2];   // = f'_{n-2}(x_{n-1})
     if(m_force_linear_extrapolation==true)
         m_b[n-1]=0.0;
+
+    m_inverse_index.build(m_y);
+
+    m_integral.resize(n);
+    m_integral[0]=0.0;
+    for(int i=0; i<n-1; i++) {
+        double h=m_x[i+1]-m_x[i];
+        m_integral[i+1]=m_integral[i]
+                        + (((m_a[i]/4.0*h + m_b[i]/3.0)*h + m_c[i]/2.0)*h + m_y[i])*h;
+    }
 }
 
-double spline::operator() (double x)
+double spline::primitive(double x) const
 {
     size_t n=m_x.size();
+    double whole_periods=0.0;
+    if(m_left==spline::periodic) {
+        // the count comes from the wrap itself, a separate floor() of the
+        // quotient may round up just below a multiple of the period
+        double period=m_x[n-1]-m_x[0];
+        double wrapped=periodic_wrap(x);
+        whole_periods=std::round((x-wrapped)/period);
+        x=wrapped;
+    }
+    double result;
+    if(x<m_x[0]) {
+        // extrapolation to the left, h<0
+        double h=x-m_x[0];
+        result=((m_b0/3.0*h + m_c0/2.0)*h + m_y[0])*h;
+    } else if(x>m_x[n-1]) {
+        double h=x-m_x[n-1];
+        result=m_integral[n-1] + ((m_b[n-1]/3.0*h + m_c[n-1]/2.0)*h + m_y[n-1])*h;
+    } else {
+        size_t idx=find_segment(m_x, x);
+        double h=x-m_x[idx];
+        result=m_integral[idx]
+               + (((m_a[idx]/4.0*h + m_b[idx]/3.0)*h + m_c[idx]/2.0)*h + m_y[idx])*h;
+    }
+    return result + whole_periods*m_integral[n-1];
+}
+
+double spline::integrate(double a, double b) const
+{
+    assert(m_x.size()>0);
+    return primitive(b)-primitive(a);
+}
+
+void spline::integrate(const double* a_from, const double* a_to, double* a_result,
+                       size_t a_count) const
+{
+    for(size_t i=0; i<a_count; i++) {
+        a_result[i]=integrate(a_from[i], a_to[i]);
+    }
+}
+
+double spline::inverse(double y) const
+{
+    size_t idx;
+    if(m_x.empty() || !m_inverse_index.find(m_y, y, idx)) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+    double h=solve_segment_cubic(m_y[idx], m_c[idx], m_b[idx], m_a[idx],
+                                 m_x[idx+1]-m_x[idx], y);
+    return m_x[idx]+h;
+}
+
+void spline::inverse(const double* a_y, double* a_x, size_t a_count) const
+{
+    for(size_t i=0; i<a_count; i++) {
+        a_x[i]=inverse(a_y[i]);
+    }
+}
+
+double spline::operator() (double x)
+{
+    SPLINES_COUNT(ic_evaluations);
+    if(m_left==spline::periodic) {
+        x=periodic_wrap(x);
+    }
     // find the closest point m_x[idx] < x, idx=0 even if x<m_x[0]
-    std::vector<double>::const_iterator it;
+    std::pmr::vector<double>::const_iterator it;
     it=std::lower_bound(m_x.begin(),m_x.end(),x);
     int idx=std::max( int(it-m_x.begin())-1, 0);
+    return calc_segment(static_cast<size_t>(idx), x);
+}
+
+void spline::calc_array(const double* a_x, double* a_y, size_t a_count)
+{
+    SPLINES_COUNT_N(ic_evaluations, a_count);
+    // neighbouring values of a sorted batch mostly share the segment
+    size_t idx=0;
+    for(size_t i=0; i<a_count; i++) {
+        double x=(m_left==spline::periodic) ? periodic_wrap(a_x[i]) : a_x[i];
+        idx=find_segment(m_x, x, idx);
+        a_y[i]=calc_segment(idx, x);
+    }
+}
 
+double spline::calc_segment(size_t idx, double x) const
+{
+    size_t n=m_x.size();
     double h=x-m_x[idx];
     double interpol;
     if(x<m_x[0]) {
         // extrapolation to the left
+        SPLINES_COUNT(ic_left_extrapolations);
         interpol=(m_b0*h + m_c0)*h + m_y[0];
     } else if(x>m_x[n-1]) {
-        // extrapolation to the right
+        // extrapolation to the right, idx may point to the last interval
+        SPLINES_COUNT(ic_right_extrapolations);
+        h=x-m_x[n-1];
         interpol=(m_b[n-1]*h + m_c[n-1])*h + m_y[n-1];
     } else {
         // interpolation
@@ -292,13 +588,87 @@ double spline::operator() (double x)
     return interpol;
 }
 
+interpolation_derivs_t spline::calc_derivs(double x)
+{
+    if(m_left==spline::periodic) {
+        x=periodic_wrap(x);
+    }
+    return calc_segment_derivs(find_segment(m_x, x), x);
+}
+
+void spline::calc_derivs_array(const double* a_x, double* a_value,
+                               double* a_first, double* a_second,
+                               size_t a_count)
+{
+    size_t idx=0;
+    for(size_t i=0; i<a_count; i++) {
+        double x=(m_left==spline::periodic) ? periodic_wrap(a_x[i]) : a_x[i];
+        idx=find_segment(m_x, x, idx);
+        interpolation_derivs_t derivs=calc_segment_derivs(idx, x);
+        a_value[i]=derivs.value;
+        a_first[i]=derivs.first;
+        a_second[i]=derivs.second;
+    }
+}
+
+interpolation_derivs_t spline::calc_segment_derivs(size_t idx, double x) const
+{
+    size_t n=m_x.size();
+    // extrapolation is quadratic, so the cubic coefficient is zero there
+    double a, b, c, y, h;
+    if(x<m_x[0]) {
+        a=0.0;
+        b=m_b0;
+        c=m_c0;
+        y=m_y[0];
+        h=x-m_x[0];
+    } else if(x>m_x[n-1]) {
+        a=0.0;
+        b=m_b[n-1];
+        c=m_c[n-1];
+        y=m_y[n-1];
+        h=x-m_x[n-1];
+    } else {
+        a=m_a[idx];
+        b=m_b[idx];
+        c=m_c[idx];
+        y=m_y[idx];
+        h=x-m_x[idx];
+    }
+    interpolation_derivs_t derivs;
+    derivs.value=((a*h + b)*h + c)*h + y;
+    derivs.first=(3.0*a*h + 2.0*b)*h + c;
+    derivs.second=6.0*a*h + 2.0*b;
+    return derivs;
+}
+
+void spline::export_piecewise(piecewise_cubic_t& curve) const
+{
+    size_t n=m_x.size();
+    curve.knots.assign(m_x.begin(), m_x.end());
+    curve.coeffs.resize((n+1)*piecewise_cubic_t::coeffs_per_segment);
+    curve.period=(m_left==spline::periodic) ? m_x[n-1]-m_x[0] : 0.0;
+    double* c=curve.coeffs.data();
+    // extrapolation is quadratic
+    c[0]=m_y[0]; c[1]=m_c0; c[2]=m_b0; c[3]=0.0;
+    for(size_t i=0; i<n-1; i++) {
+        c+=piecewise_cubic_t::coeffs_per_segment;
+        c[0]=m_y[i]; c[1]=m_c[i]; c[2]=m_b[i]; c[3]=m_a[i];
+    }
+    c+=piecewise_cubic_t::coeffs_per_segment;
+    c[0]=m_y[n-1]; c[1]=m_c[n-1]; c[2]=m_b[n-1]; c[3]=0.0;
+}
+
 double spline::deriv(int order, double x) const
 {
     assert(order>0);
 
+    if(m_left==spline::periodic) {
+        x=periodic_wrap(x);
+    }
     size_t n=m_x.size();
     // find the closest point m_x[idx] < x, idx=0 even if x<m_x[0]
-    std::vector<double>::const_iterator it;
+    std::pmr::vector<double>::const_iterator it;
     it=std::lower_bound(m_x.begin(),m_x.end(),x);
     int idx=std::max( int(it-m_x.begin())-1, 0);
 
@@ -311,7 +681,7 @@ double spline::deriv(int order, double x) const
             interpol=2.0*m_b0*h + m_c0;
             break;
         case 2:
-            interpol=2.0*m_b0*h;
+            interpol=2.0*m_b0;
             break;
         default:
             interpol=0.0;
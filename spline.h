@@ -28,25 +28,32 @@
 #define TK_SPLINE_H
 
 #include "interpolation_base.h"
+#include "inverse_search.h"
+#include "piecewise_cubic.h"
 
 #include <cstdio>
 #include <cassert>
 #include <vector>
+#include <memory_resource>
 #include <algorithm>
 
 
 namespace tk
 {
 
-// band matrix solver
+// band matrix solver, the bands and the solutions are allocated
+// from the memory resource given to the constructor
 class band_matrix
 {
 private:
-    std::vector< std::vector<double> > m_upper;  // upper band
-    std::vector< std::vector<double> > m_lower;  // lower band
+    std::pmr::vector< std::pmr::vector<double> > m_upper;  // upper band
+    std::pmr::vector< std::pmr::vector<double> > m_lower;  // lower band
 public:
-    band_matrix() {}                              // constructor
-    band_matrix(int dim, int n_u, int n_l);       // constructor
+    explicit band_matrix(std::pmr::memory_resource* resource=
+                             std::pmr::get_default_resource()); // constructor
+    band_matrix(int dim, int n_u, int n_l,
+                std::pmr::memory_resource* resource=
+                    std::pmr::get_default_resource());          // constructor
     ~band_matrix() {}                             // destructor
     void resize(int dim, int n_u, int n_l);      // init with dim,n_u,n_l
     int dim() const;                             // matrix dimension
@@ -64,7 +71,14 @@ public:
     // we can store an additional diogonal (in m_lower)
     double& saved_diag(int i);
     double  saved_diag(int i) const;
+    std::pmr::memory_resource* resource() const;
     void lu_decompose();
+    // solutions of pmr right hand sides come from resource(),
+    // std::vector right hand sides give std::vector solutions
+    std::pmr::vector<double> r_solve(const std::pmr::vector<double>& b) const;
+    std::pmr::vector<double> l_solve(const std::pmr::vector<double>& b) const;
+    std::pmr::vector<double> lu_solve(const std::pmr::vector<double>& b,
+                                      bool is_lu_decomposed=false);
     std::vector<double> r_solve(const std::vector<double>& b) const;
     std::vector<double> l_solve(const std::vector<double>& b) const;
     std::vector<double> lu_solve(const std::vector<double>& b,
@@ -72,32 +86,52 @@ public:
 
 };
 
+// solves a cyclic tridiagonal system in O(n), A holds the tridiagonal part
+// (dim>2) and is overwritten, alpha=A(n-1,0) and beta=A(0,n-1) are the corners
+std::pmr::vector<double> cyclic_solve(band_matrix& A, double alpha, double beta,
+                                      const std::pmr::vector<double>& rhs);
+std::vector<double> cyclic_solve(band_matrix& A, double alpha, double beta,
+                                 const std::vector<double>& rhs);
 
-// spline interpolation
+
+// spline interpolation, all storage and the temporaries of set_points()
+// come from the memory resource given to the constructor, so that many
+// splines can share one arena
 class spline : public interpolation_base_t
 {
 public:
     enum bd_type {
         first_deriv = 1,
-        second_deriv = 2
+        second_deriv = 2,
+        not_a_knot = 3,         // f''' continuous in the second and last but one knot
+        periodic = 4            // both sides, y[n-1] is replaced by y[0]
     };
 
 private:
-    std::vector<double> m_x,m_y;            // x,y coordinates of points
+    std::pmr::vector<double> m_x,m_y;       // x,y coordinates of points
     // interpolation parameters
     // f(x) = a*(x-x_i)^3 + b*(x-x_i)^2 + c*(x-x_i) + y_i
-    std::vector<double> m_a,m_b,m_c;        // spline coefficients
+    std::pmr::vector<double> m_a,m_b,m_c;   // spline coefficients
     double  m_b0, m_c0;                     // for left extrapol
     bd_type m_left, m_right;
     double  m_left_value, m_right_value;
     bool    m_force_linear_extrapolation;
+    monotone_index_t<double> m_inverse_index;
+    std::pmr::vector<double> m_integral;    // integral from x[0] to x[i]
 
 public:
     // set default boundary condition to be zero curvature at both ends
     spline();
+    explicit spline(std::pmr::memory_resource* resource);
     virtual ~spline() override;
     virtual void set_points(const double* a_x, const double* a_y, size_t a_size) override;
     virtual double operator() (double x) override;
+    virtual void calc_array(const double* a_x, double* a_y, size_t a_count) override;
+    // value, first and second derivative from a single segment search
+    virtual interpolation_derivs_t calc_derivs(double x) override;
+    virtual void calc_derivs_array(const double* a_x, double* a_value,
+                                   double* a_first, double* a_second,
+                                   size_t a_count) override;
 
 
     // optional, but if called it has to come be before set_points()
@@ -105,6 +139,30 @@ public:
                       bd_type right, double right_value,
                       bool force_linear_extrapolation=false);
     double deriv(int order, double x) const;
+    // solves f(x)=y between the knots, NaN if y is outside of the knot
+    // values; for non-monotone data the root in the first segment whose
+    // knot values bracket y is returned. A segment that overshoots its
+    // knot values may hold a root with a smaller x, which is not found
+    double inverse(double y) const;
+    void inverse(const double* a_y, double* a_x, size_t a_count) const;
+    // integral of f from a to b (b<a gives the negative value), closed form
+    // including the extrapolated parts, O(log n) via the prefix sum table
+    double integrate(double a, double b) const;
+    void integrate(const double* a_from, const double* a_to, double* a_result,
+                   size_t a_count) const;
+    // coefficients in the interpolation independent form, see piecewise_cubic_t
+    void export_piecewise(piecewise_cubic_t& curve) const;
+
+private:
+    void set_coeffs();
+    void set_periodic_coeffs();
+    void set_a_c_from_b();
+    // maps x into [x[0], x[n-1]) for periodic splines
+    double periodic_wrap(double x) const;
+    // integral from x[0] to x
+    double primitive(double x) const;
+    double calc_segment(size_t idx, double x) const;
+    interpolation_derivs_t calc_segment_derivs(size_t idx, double x) const;
 };
 
 
@@ -0,0 +1,148 @@
+#include "spline_family.h"
+#include "spline.h"
+#include "hermit.h"
+#include "parallel_for.h"
+#include "piecewise_cubic.h"
+
+#include <algorithm>
+#include <cassert>
+#include <memory_resource>
+
+namespace tk {
+
+namespace {
+
+// a thread fits at least that many curves
+const size_t min_curves_per_thread=256;
+// points evaluated per segment search pass in calc_array()
+const size_t eval_chunk_size=256;
+
+} // namespace
+
+
+spline_family::spline_family(): m_offsets(1, 0), m_x(), m_y(), m_coeffs(),
+    m_fitted(false)
+{
+}
+
+void spline_family::reserve(size_t curves, size_t total_knots)
+{
+    m_offsets.reserve(curves+1);
+    m_x.reserve(total_knots);
+    m_y.reserve(total_knots);
+    m_coeffs.reserve((total_knots+curves)*piecewise_cubic_t::coeffs_per_segment);
+}
+
+void spline_family::clear()
+{
+    m_offsets.assign(1, 0);
+    m_x.clear();
+    m_y.clear();
+    m_coeffs.clear();
+    m_fitted=false;
+}
+
+size_t spline_family::add_curve(const double* x, const double* y, size_t count)
+{
+    assert(count>=2);
+    for(size_t i=1; i<count; i++) {
+        assert(x[i-1]<x[i]);
+    }
+    m_x.insert(m_x.end(), x, x+count);
+    m_y.insert(m_y.end(), y, y+count);
+    m_offsets.push_back(m_x.size());
+    m_fitted=false;
+    return size()-1;
+}
+
+size_t spline_family::size() const
+{
+    return m_offsets.size()-1;
+}
+
+size_t spline_family::knot_count(size_t curve) const
+{
+    assert(curve<size());
+    return m_offsets[curve+1]-m_offsets[curve];
+}
+
+void spline_family::fit(fit_type type, size_t thread_count)
+{
+    const size_t curves=size();
+    m_coeffs.resize((m_x.size()+curves)*piecewise_cubic_t::coeffs_per_segment);
+    thread_count=parallel_thread_count(curves, min_curves_per_thread, thread_count);
+
+    for_each_chunk(curves, thread_count, [&](size_t, size_t begin, size_t end) {
+        // the fit temporaries of one curve are dropped at once
+        char buffer[16*1024];
+        std::pmr::monotonic_buffer_resource arena(buffer, sizeof(buffer));
+        piecewise_cubic_t curve;
+        for(size_t i=begin; i<end; i++) {
+            const size_t offset=m_offsets[i];
+            const size_t n=m_offsets[i+1]-offset;
+            if(type==spline_family::pchip) {
+                pchip_t<double> fit(&arena);
+                fit.set_points(&m_x[offset], &m_y[offset], n);
+                fit.export_piecewise(curve);
+            } else {
+                spline fit(&arena);
+                fit.set_points(&m_x[offset], &m_y[offset], n);
+                fit.export_piecewise(curve);
+            }
+            arena.release();
+            std::copy(curve.coeffs.begin(), curve.coeffs.end(),
+                      m_coeffs.begin()+(offset+i)*piecewise_cubic_t::coeffs_per_segment);
+        }
+    });
+    m_fitted=true;
+}
+
+bool spline_family::is_fitted() const
+{
+    return m_fitted;
+}
+
+size_t spline_family::find_segment(size_t curve, double x) const
+{
+    const double* begin=m_x.data()+m_offsets[curve];
+    const double* end=m_x.data()+m_offsets[curve+1];
+    return static_cast<size_t>(std::upper_bound(begin, end, x)-begin);
+}
+
+double spline_family::operator() (size_t curve, double x) const
+{
+    assert(m_fitted);
+    assert(curve<size());
+    const size_t offset=m_offsets[curve];
+    return piecewise_cubic_value(&m_x[offset],
+                                 &m_coeffs[(offset+curve)*piecewise_cubic_t::coeffs_per_segment],
+                                 m_offsets[curve+1]-offset, 0.0, x);
+}
+
+void spline_family::calc_array(const size_t* curves, const double* x, double* y,
+                               size_t count) const
+{
+    assert(m_fitted);
+    size_t coeff_index[eval_chunk_size];
+    double h[eval_chunk_size];
+    for(size_t begin=0; begin<count; begin+=eval_chunk_size) {
+        const size_t chunk=std::min(eval_chunk_size, count-begin);
+        for(size_t k=0; k<chunk; k++) {
+            const size_t curve=curves[begin+k];
+            assert(curve<size());
+            const size_t segment=find_segment(curve, x[begin+k]);
+            const size_t anchor=m_offsets[curve]+(segment==0 ? 0 : segment-1);
+            coeff_index[k]=(m_offsets[curve]+curve+segment)*piecewise_cubic_t::coeffs_per_segment;
+            h[k]=x[begin+k]-m_x[anchor];
+        }
+        const double* c=m_coeffs.data();
+        for(size_t k=0; k<chunk; k++) {
+            const size_t i=coeff_index[k];
+            const double t=h[k];
+            y[begin+k]=c[i] + t*(c[i+1] + t*(c[i+2] + t*c[i+3]));
+        }
+    }
+}
+
+
+} // namespace tk
@@ -0,0 +1,61 @@
+/*
+ * spline_family.h
+ *
+ * many small curves in shared flat arrays: knots of all curves one after
+ * another, an offsets table and the coefficients in the piecewise_cubic_t
+ * layout (n+1 segments per curve, extrapolation included)
+ *
+ */
+
+
+#ifndef TK_SPLINE_FAMILY_H
+#define TK_SPLINE_FAMILY_H
+
+#include <cstddef>
+#include <vector>
+
+
+namespace tk
+{
+
+class spline_family
+{
+public:
+    enum fit_type {
+        cubic = 0,              // tk::spline with the default boundary
+        pchip = 1               // pchip_t
+    };
+
+    spline_family();
+
+    void reserve(size_t curves, size_t total_knots);
+    void clear();
+    // appends a curve, x must be strictly increasing, returns its id
+    size_t add_curve(const double* x, const double* y, size_t count);
+    size_t size() const;
+    size_t knot_count(size_t curve) const;
+
+    // fits all curves, threads split the curves, 0 threads means all cores
+    void fit(fit_type type, size_t thread_count=0);
+    bool is_fitted() const;
+
+    double operator() (size_t curve, double x) const;
+    // y[i] = curve[i](x[i]), segments of a chunk are found first and the
+    // polynomials are evaluated in a separate loop over gathered coefficients
+    void calc_array(const size_t* curves, const double* x, double* y,
+                    size_t count) const;
+
+private:
+    std::vector<size_t> m_offsets;          // curve i has knots [m_offsets[i], m_offsets[i+1])
+    std::vector<double> m_x,m_y;
+    // 4 values per segment, segments of curve i start at m_offsets[i]+i
+    std::vector<double> m_coeffs;
+    bool m_fitted;
+
+    size_t find_segment(size_t curve, double x) const;
+};
+
+} // namespace tk
+
+
+#endif /* TK_SPLINE_FAMILY_H */
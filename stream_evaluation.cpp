@@ -0,0 +1,329 @@
+#include "stream_evaluation.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdlib>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <thread>
+
+namespace {
+
+struct stream_chunk_t
+{
+  std::size_t sequence;
+  //Whole lines of a text input
+  std::vector<char> text;
+  std::vector<double> x;
+  std::vector<double> y;
+  //Formatted text output
+  std::string output;
+  std::uint64_t skipped;
+
+  stream_chunk_t():
+    sequence(0),
+    text(),
+    x(),
+    y(),
+    output(),
+    skipped(0)
+  {
+  }
+};
+
+template <class T>
+class blocking_queue_t
+{
+public:
+  blocking_queue_t():
+    m_mutex(),
+    m_condition(),
+    m_items(),
+    m_closed(false)
+  {
+  }
+
+  void push(T a_item)
+  {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_items.push_back(a_item);
+    }
+    m_condition.notify_one();
+  }
+
+  //Waits for an item, false if the queue is closed and empty
+  bool pop(T& a_item)
+  {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_condition.wait(lock, [this]() { return m_closed || !m_items.empty(); });
+    if (m_items.empty()) {
+      return false;
+    }
+    a_item = m_items.front();
+    m_items.pop_front();
+    return true;
+  }
+
+  void close()
+  {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_closed = true;
+    }
+    m_condition.notify_all();
+  }
+
+private:
+  std::mutex m_mutex;
+  std::condition_variable m_condition;
+  std::deque<T> m_items;
+  bool m_closed;
+};
+
+class stream_pipeline_t
+{
+public:
+  stream_pipeline_t(std::FILE* ap_input, std::FILE* ap_output,
+    const std::vector<std::unique_ptr<interpolation_base_t>>& a_interpolations,
+    const stream_options_t& a_options):
+    mp_input(ap_input),
+    mp_output(ap_output),
+    m_interpolations(a_interpolations),
+    m_options(a_options),
+    m_chunks(),
+    m_free(),
+    m_evaluate(),
+    m_write(),
+    m_failed(false),
+    m_error_mutex(),
+    m_error(),
+    m_stats()
+  {
+    std::size_t chunk_count = m_options.chunk_count;
+    if (chunk_count == 0) {
+      chunk_count = m_interpolations.size() + 2;
+    }
+    m_options.chunk_bytes = std::max<std::size_t>(m_options.chunk_bytes, sizeof(double));
+    for (std::size_t i = 0; i < chunk_count; i++) {
+      m_chunks.emplace_back(new stream_chunk_t());
+      m_free.push(m_chunks.back().get());
+    }
+  }
+
+  bool run(stream_stats_t& a_stats, std::string& a_error)
+  {
+    std::vector<std::thread> workers;
+    for (std::size_t i = 0; i < m_interpolations.size(); i++) {
+      workers.emplace_back(&stream_pipeline_t::evaluate_chunks, this,
+        m_interpolations[i].get());
+    }
+    std::thread writer(&stream_pipeline_t::write_chunks, this);
+
+    read_chunks();
+    m_evaluate.close();
+    for (auto& worker: workers) {
+      worker.join();
+    }
+    m_write.close();
+    writer.join();
+
+    a_stats = m_stats;
+    if (m_failed) {
+      a_error = m_error;
+      return false;
+    }
+    return true;
+  }
+
+private:
+  std::FILE* mp_input;
+  std::FILE* mp_output;
+  const std::vector<std::unique_ptr<interpolation_base_t>>& m_interpolations;
+  stream_options_t m_options;
+  std::vector<std::unique_ptr<stream_chunk_t>> m_chunks;
+  //Chunks go free -> evaluate -> write -> free, there are no other
+  //allocations of the buffers, so the memory use is bounded
+  blocking_queue_t<stream_chunk_t*> m_free;
+  blocking_queue_t<stream_chunk_t*> m_evaluate;
+  blocking_queue_t<stream_chunk_t*> m_write;
+  std::atomic<bool> m_failed;
+  std::mutex m_error_mutex;
+  std::string m_error;
+  stream_stats_t m_stats;
+
+  //Stops all stages, the first error is reported
+  void fail(const std::string& a_error)
+  {
+    {
+      std::lock_guard<std::mutex> lock(m_error_mutex);
+      if (!m_failed) {
+        m_error = a_error;
+        m_failed = true;
+      }
+    }
+    m_free.close();
+    m_evaluate.close();
+    m_write.close();
+  }
+
+  void read_chunks()
+  {
+    std::vector<char> carry;
+    bool end_of_file = false;
+    for (std::size_t sequence = 0; !end_of_file; sequence++) {
+      stream_chunk_t* chunk = nullptr;
+      if (!m_free.pop(chunk) || m_failed) {
+        return;
+      }
+      chunk->sequence = sequence;
+      end_of_file = (m_options.input_format == stream_format_t::text) ?
+        read_text(*chunk, carry) : read_binary(*chunk);
+      if (std::ferror(mp_input)) {
+        fail("read error");
+        return;
+      }
+      m_evaluate.push(chunk);
+    }
+  }
+
+  //Returns true at the end of the input, the last incomplete line
+  //is moved to a_carry and goes to the next chunk
+  bool read_text(stream_chunk_t& a_chunk, std::vector<char>& a_carry)
+  {
+    a_chunk.text.swap(a_carry);
+    a_carry.clear();
+    for (;;) {
+      std::size_t size = a_chunk.text.size();
+      a_chunk.text.resize(size + m_options.chunk_bytes);
+      std::size_t read = std::fread(a_chunk.text.data() + size, 1, m_options.chunk_bytes,
+        mp_input);
+      a_chunk.text.resize(size + read);
+      if (read < m_options.chunk_bytes) {
+        return true;
+      }
+      auto last_newline = std::find(a_chunk.text.rbegin(), a_chunk.text.rend(), '\n');
+      if (last_newline != a_chunk.text.rend()) {
+        a_carry.assign(last_newline.base(), a_chunk.text.end());
+        a_chunk.text.erase(last_newline.base(), a_chunk.text.end());
+        return false;
+      }
+      //A line longer than the chunk, the chunk grows
+    }
+  }
+
+  bool read_binary(stream_chunk_t& a_chunk)
+  {
+    const std::size_t chunk_points = m_options.chunk_bytes / sizeof(double);
+    a_chunk.x.resize(chunk_points);
+    //Read as bytes, the position after a partially read item is unspecified
+    std::size_t read = std::fread(a_chunk.x.data(), 1, chunk_points * sizeof(double), mp_input);
+    a_chunk.x.resize(read / sizeof(double));
+    if (read % sizeof(double) != 0) {
+      fail("input size is not a multiple of 8 bytes");
+      return true;
+    }
+    return read < chunk_points * sizeof(double);
+  }
+
+  static void parse_text(stream_chunk_t& a_chunk)
+  {
+    a_chunk.x.clear();
+    a_chunk.skipped = 0;
+    const char* begin = a_chunk.text.data();
+    const char* end = begin + a_chunk.text.size();
+    std::string line;
+    while (begin < end) {
+      const char* line_end = std::find(begin, end, '\n');
+      line.assign(begin, line_end);
+      line.erase(line.find_last_not_of(" \t\r") + 1);
+      if (!line.empty()) {
+        char* parse_end = nullptr;
+        double value = std::strtod(line.c_str(), &parse_end);
+        if ((parse_end != line.c_str()) && (*parse_end == '\0')) {
+          a_chunk.x.push_back(value);
+        } else {
+          a_chunk.skipped++;
+        }
+      }
+      begin = (line_end == end) ? end : line_end + 1;
+    }
+  }
+
+  void evaluate_chunks(interpolation_base_t* ap_interpolation)
+  {
+    stream_chunk_t* chunk = nullptr;
+    while (m_evaluate.pop(chunk) && !m_failed) {
+      if (m_options.input_format == stream_format_t::text) {
+        parse_text(*chunk);
+      }
+      chunk->y.resize(chunk->x.size());
+      ap_interpolation->calc_array(chunk->x.data(), chunk->y.data(), chunk->x.size());
+      if (m_options.output_format == stream_format_t::text) {
+        chunk->output.clear();
+        format_xy_text(chunk->x.data(), chunk->y.data(), chunk->x.size(), chunk->output);
+      }
+      m_write.push(chunk);
+    }
+  }
+
+  void write_chunks()
+  {
+    //Chunks are evaluated in any order, written in the input order
+    std::map<std::size_t, stream_chunk_t*> pending;
+    std::size_t next_sequence = 0;
+    stream_chunk_t* chunk = nullptr;
+    while (m_write.pop(chunk) && !m_failed) {
+      pending[chunk->sequence] = chunk;
+      while (!pending.empty() && (pending.begin()->first == next_sequence)) {
+        stream_chunk_t* ready = pending.begin()->second;
+        pending.erase(pending.begin());
+        if (!write(*ready)) {
+          fail("write error");
+          return;
+        }
+        m_stats.evaluated += ready->x.size();
+        m_stats.skipped += ready->skipped;
+        m_stats.chunks++;
+        next_sequence++;
+        m_free.push(ready);
+      }
+    }
+  }
+
+  bool write(const stream_chunk_t& a_chunk)
+  {
+    if (m_options.output_format == stream_format_t::text) {
+      return std::fwrite(a_chunk.output.data(), 1, a_chunk.output.size(), mp_output) ==
+        a_chunk.output.size();
+    }
+    return std::fwrite(a_chunk.y.data(), sizeof(double), a_chunk.y.size(), mp_output) ==
+      a_chunk.y.size();
+  }
+};
+
+} // namespace
+
+bool evaluate_stream(std::FILE* ap_input, std::FILE* ap_output,
+  const std::vector<std::unique_ptr<interpolation_base_t>>& a_interpolations,
+  const stream_options_t& a_options, stream_stats_t& a_stats, std::string& a_error)
+{
+  if (a_interpolations.empty()) {
+    a_error = "no interpolations to evaluate with";
+    return false;
+  }
+  stream_pipeline_t pipeline(ap_input, ap_output, a_interpolations, a_options);
+  return pipeline.run(a_stats, a_error);
+}
+
+void format_xy_text(const double* a_x, const double* a_y, std::size_t a_count,
+  std::string& a_text)
+{
+  char line[64];
+  for (std::size_t i = 0; i < a_count; i++) {
+    int length = std::snprintf(line, sizeof(line), "%.17g;%.17g\n", a_x[i], a_y[i]);
+    a_text.append(line, static_cast<std::size_t>(length));
+  }
+}
@@ -0,0 +1,69 @@
+#ifndef STREAM_EVALUATION_H
+#define STREAM_EVALUATION_H
+
+#include "interpolation_base.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+enum class stream_format_t {
+  //Input has one x per line, output has "x;y" lines
+  text,
+  //Native doubles, output holds only y
+  binary
+};
+
+struct stream_options_t
+{
+  stream_format_t input_format;
+  stream_format_t output_format;
+  //Input bytes read at once
+  std::size_t chunk_bytes;
+  //Chunks in flight, 0 is evaluation threads + 2 so that reading and
+  //writing never wait for each other. Memory use is bounded by
+  //chunk_count chunks of input, x, y and output
+  std::size_t chunk_count;
+
+  stream_options_t():
+    input_format(stream_format_t::text),
+    output_format(stream_format_t::text),
+    chunk_bytes(1 << 20),
+    chunk_count(0)
+  {
+  }
+};
+
+struct stream_stats_t
+{
+  std::uint64_t evaluated;
+  //Text lines that are not a number
+  std::uint64_t skipped;
+  std::uint64_t chunks;
+
+  stream_stats_t():
+    evaluated(0),
+    skipped(0),
+    chunks(0)
+  {
+  }
+};
+
+//Evaluates every x of ap_input and writes the results to ap_output in the
+//input order. One thread reads ahead, every interpolation evaluates chunks
+//in its own thread, one more thread writes finished chunks, so the stages
+//overlap and the files may be larger than the memory.
+//The interpolations must be separately fitted copies of the same curve.
+//Returns false and a_error on a read or write error
+bool evaluate_stream(std::FILE* ap_input, std::FILE* ap_output,
+  const std::vector<std::unique_ptr<interpolation_base_t>>& a_interpolations,
+  const stream_options_t& a_options, stream_stats_t& a_stats, std::string& a_error);
+
+//Appends "x;y\n" lines with full precision
+void format_xy_text(const double* a_x, const double* a_y, std::size_t a_count,
+  std::string& a_text);
+
+#endif // STREAM_EVALUATION_H
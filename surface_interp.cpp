@@ -0,0 +1,164 @@
+#include "surface_interp.h"
+
+#include "hermit.h"
+#include "segment_search.h"
+#include "spline.h"
+
+#include <cassert>
+
+surface_interp_t::surface_interp_t(kind_t a_kind) :
+  m_kind(a_kind),
+  m_x(),
+  m_y(),
+  m_z(),
+  m_coeffs()
+{
+}
+
+void surface_interp_t::set_grid(const double* a_x, size_t a_x_size,
+  const double* a_y, size_t a_y_size, const double* a_z)
+{
+  assert(a_x_size >= 2 && a_y_size >= 2);
+  m_x.assign(a_x, a_x + a_x_size);
+  m_y.assign(a_y, a_y + a_y_size);
+  m_z.assign(a_z, a_z + a_x_size * a_y_size);
+
+  if (m_kind == kind_t::bilinear) {
+    m_coeffs.clear();
+    return;
+  }
+
+  const size_t nx = a_x_size;
+  const size_t ny = a_y_size;
+  std::vector<double> fx(nx * ny);
+  std::vector<double> fy(nx * ny);
+  std::vector<double> fxy(nx * ny);
+  //df/dx along every row, df/dy along every column,
+  //d2f/dxdy along every column of df/dx
+  for (size_t j = 0; j < ny; j++) {
+    calc_axis_derivatives(m_x, &m_z[j * nx], 1, &fx[j * nx], 1);
+  }
+  for (size_t i = 0; i < nx; i++) {
+    calc_axis_derivatives(m_y, &m_z[i], nx, &fy[i], nx);
+    calc_axis_derivatives(m_y, &fx[i], nx, &fxy[i], nx);
+  }
+  calc_cell_coeffs(fx, fy, fxy);
+}
+
+void surface_interp_t::calc_axis_derivatives(const std::vector<double>& a_t,
+  const double* a_values, size_t a_stride, double* a_derivatives, size_t a_out_stride) const
+{
+  const size_t n = a_t.size();
+  std::vector<double> values(n);
+  for (size_t k = 0; k < n; k++) {
+    values[k] = a_values[k * a_stride];
+  }
+
+  if (m_kind == kind_t::pchip) {
+    pchip_t<double> pchip;
+    pchip.set_points(a_t.data(), values.data(), n);
+    const std::vector<double> derivatives = pchip.knot_derivatives();
+    for (size_t k = 0; k < n; k++) {
+      a_derivatives[k * a_out_stride] = derivatives[k];
+    }
+  } else {
+    tk::spline spline;
+    spline.set_points(a_t.data(), values.data(), n);
+    for (size_t k = 0; k < n; k++) {
+      a_derivatives[k * a_out_stride] = spline.deriv(1, a_t[k]);
+    }
+  }
+}
+
+void surface_interp_t::calc_cell_coeffs(const std::vector<double>& a_fx,
+  const std::vector<double>& a_fy, const std::vector<double>& a_fxy)
+{
+  const size_t nx = m_x.size();
+  const size_t ny = m_y.size();
+  m_coeffs.resize((nx - 1) * (ny - 1) * cell_coeffs_count);
+
+  //Coefficients are M * F * M^T, F holds the corner values and
+  //derivatives scaled to the unit cell
+  static const double m[4][4] = {
+    {  1,  0,  0,  0 },
+    {  0,  0,  1,  0 },
+    { -3,  3, -2, -1 },
+    {  2, -2,  1,  1 }
+  };
+  for (size_t j = 0; j < ny - 1; j++) {
+    const double hy = m_y[j + 1] - m_y[j];
+    for (size_t i = 0; i < nx - 1; i++) {
+      const double hx = m_x[i + 1] - m_x[i];
+      const size_t p00 = j * nx + i;
+      const size_t p10 = p00 + 1;
+      const size_t p01 = p00 + nx;
+      const size_t p11 = p01 + 1;
+      const double f[4][4] = {
+        { m_z[p00], m_z[p01], a_fy[p00] * hy, a_fy[p01] * hy },
+        { m_z[p10], m_z[p11], a_fy[p10] * hy, a_fy[p11] * hy },
+        { a_fx[p00] * hx, a_fx[p01] * hx, a_fxy[p00] * hx * hy, a_fxy[p01] * hx * hy },
+        { a_fx[p10] * hx, a_fx[p11] * hx, a_fxy[p10] * hx * hy, a_fxy[p11] * hx * hy }
+      };
+      double mf[4][4];
+      for (int r = 0; r < 4; r++) {
+        for (int c = 0; c < 4; c++) {
+          double sum = 0;
+          for (int k = 0; k < 4; k++) {
+            sum += m[r][k] * f[k][c];
+          }
+          mf[r][c] = sum;
+        }
+      }
+      double* coeffs = &m_coeffs[(j * (nx - 1) + i) * cell_coeffs_count];
+      for (int r = 0; r < 4; r++) {
+        for (int c = 0; c < 4; c++) {
+          double sum = 0;
+          for (int k = 0; k < 4; k++) {
+            sum += mf[r][k] * m[c][k];
+          }
+          coeffs[r * 4 + c] = sum;
+        }
+      }
+    }
+  }
+}
+
+double surface_interp_t::calc_cell(size_t a_ix, size_t a_iy, double a_x, double a_y) const
+{
+  const double u = (a_x - m_x[a_ix]) / (m_x[a_ix + 1] - m_x[a_ix]);
+  const double v = (a_y - m_y[a_iy]) / (m_y[a_iy + 1] - m_y[a_iy]);
+
+  if (m_kind == kind_t::bilinear) {
+    const size_t nx = m_x.size();
+    const size_t p00 = a_iy * nx + a_ix;
+    const double z0 = m_z[p00] + u * (m_z[p00 + 1] - m_z[p00]);
+    const double z1 = m_z[p00 + nx] + u * (m_z[p00 + nx + 1] - m_z[p00 + nx]);
+    return z0 + v * (z1 - z0);
+  }
+
+  //p(u, v) = sum a[r][c] * u^r * v^c
+  const double* a = &m_coeffs[(a_iy * (m_x.size() - 1) + a_ix) * cell_coeffs_count];
+  double result = 0;
+  for (int r = 3; r >= 0; r--) {
+    const double* row = a + r * 4;
+    result = result * u + (((row[3] * v + row[2]) * v + row[1]) * v + row[0]);
+  }
+  return result;
+}
+
+double surface_interp_t::operator()(double a_x, double a_y) const
+{
+  return calc_cell(find_segment(m_x, a_x), find_segment(m_y, a_y), a_x, a_y);
+}
+
+void surface_interp_t::calc_array(const double* a_x, const double* a_y, double* a_z,
+  size_t a_count) const
+{
+  size_t ix = 0;
+  size_t iy = 0;
+  for (size_t k = 0; k < a_count; k++) {
+    ix = find_segment(m_x, a_x[k], ix);
+    iy = find_segment(m_y, a_y[k], iy);
+    a_z[k] = calc_cell(ix, iy, a_x[k], a_y[k]);
+  }
+}
@@ -0,0 +1,49 @@
+#ifndef SURFACE_INTERP_H
+#define SURFACE_INTERP_H
+
+#include <cstddef>
+#include <vector>
+
+//Tensor product interpolation z = f(x, y) over a rectangular grid,
+//for example over the whole table loaded by import_points_t.
+//Fitting is done once in set_grid(), evaluation does not refit anything
+class surface_interp_t
+{
+public:
+  enum class kind_t {
+    bilinear,
+    //Natural cubic splines along both axes (de Boor's bicubic spline)
+    bicubic,
+    //Shape preserving pchip derivatives along each axis
+    pchip
+  };
+
+  explicit surface_interp_t(kind_t a_kind = kind_t::bicubic);
+
+  //a_z holds a_y_size rows of a_x_size values, row j belongs to a_y[j].
+  //Both axes must be strictly increasing and have at least 2 points
+  void set_grid(const double* a_x, size_t a_x_size, const double* a_y, size_t a_y_size,
+    const double* a_z);
+  double operator()(double a_x, double a_y) const;
+  //Sorted queries (scanlines) are the fast case
+  void calc_array(const double* a_x, const double* a_y, double* a_z, size_t a_count) const;
+
+private:
+  enum { cell_coeffs_count = 16 };
+
+  kind_t m_kind;
+  std::vector<double> m_x;
+  std::vector<double> m_y;
+  std::vector<double> m_z;
+  //16 power basis coefficients for every cell in local coordinates u, v in [0, 1],
+  //cell (i, j) starts at ((j * (nx - 1)) + i) * 16
+  std::vector<double> m_coeffs;
+
+  void calc_axis_derivatives(const std::vector<double>& a_t, const double* a_values,
+    size_t a_stride, double* a_derivatives, size_t a_out_stride) const;
+  void calc_cell_coeffs(const std::vector<double>& a_fx, const std::vector<double>& a_fy,
+    const std::vector<double>& a_fxy);
+  double calc_cell(size_t a_ix, size_t a_iy, double a_x, double a_y) const;
+};
+
+#endif // SURFACE_INTERP_H
@@ -0,0 +1,195 @@
+#include "table_fit.h"
+#include "input_normalization.h"
+#include "knot_subset.h"
+#include "parallel_for.h"
+
+#include <atomic>
+#include <cstdio>
+#include <memory>
+
+namespace {
+
+//Everything a thread reuses from one series to the next
+struct table_fit_thread_t
+{
+  std::vector<std::unique_ptr<interpolation_base_t>> interpolations;
+  std::vector<double> x;
+  std::vector<double> y;
+  knot_subset_t knots;
+  std::vector<double> knot_x;
+  std::vector<double> knot_y;
+  std::vector<double> calculated;
+};
+
+const char* select_name(table_select_t a_select)
+{
+  return (a_select == table_select_t::row) ? "row" : "col";
+}
+
+std::string format_number(double a_value)
+{
+  char number[32];
+  std::snprintf(number, sizeof(number), "%.10g", a_value);
+  return number;
+}
+
+} // namespace
+
+const char* series_fit_status_name(series_fit_status_t a_status)
+{
+  switch (a_status) {
+    case series_fit_status_t::ok: return "ok";
+    case series_fit_status_t::ends_only: return "ends_only";
+    case series_fit_status_t::not_enough_points: return "not_enough_points";
+  }
+  return "";
+}
+
+std::vector<series_fit_t> fit_table(const table_t& a_table, const table_fit_options_t& a_options)
+{
+  const std::size_t series_count = (a_options.select == table_select_t::row) ?
+    a_table.rows : a_table.cols;
+  std::vector<interpolation_type_t> types;
+  for (size_t type = 0; type < it_count; type++) {
+    if (a_options.enable[type]) {
+      types.push_back(static_cast<interpolation_type_t>(type));
+    }
+  }
+  if ((series_count < 2) || types.empty()) {
+    return std::vector<series_fit_t>();
+  }
+
+  //The first row or column holds X
+  const std::size_t fit_count = series_count - 1;
+  std::vector<series_fit_t> results(fit_count * types.size());
+  const std::size_t thread_count = parallel_thread_count(fit_count, 1, a_options.threads);
+  std::vector<table_fit_thread_t> threads(thread_count);
+  std::atomic<bool> cancelled(false);
+
+  for_each_stealing(fit_count, thread_count, [&](std::size_t a_thread, std::size_t a_item) {
+    //Remaining series are only skipped, for_each_stealing still hands them out
+    if (cancelled || (a_options.is_cancelled && a_options.is_cancelled())) {
+      cancelled = true;
+      return;
+    }
+    table_fit_thread_t& data = threads[a_thread];
+    if (data.interpolations.empty()) {
+      for (interpolation_type_t type: types) {
+        data.interpolations.push_back(make_interpolation(type));
+      }
+    }
+    const std::size_t index = a_item + 1;
+    table_series(a_table, a_options.select, index, data.x, data.y);
+    normalize_points(data.x, data.y);
+
+    series_fit_status_t status = series_fit_status_t::ok;
+    if (data.x.size() < 2) {
+      status = series_fit_status_t::not_enough_points;
+    } else if (a_options.knots.empty()) {
+      data.knot_x = data.x;
+      data.knot_y = data.y;
+    } else {
+      if ((a_options.knots.size() < 2) || !data.knots.assign(data.x, a_options.knots)) {
+        status = series_fit_status_t::ends_only;
+        data.knots.assign_ends(data.x.size());
+      }
+      data.knots.gather(data.x, data.knot_x);
+      data.knots.gather(data.y, data.knot_y);
+    }
+
+    for (std::size_t type = 0; type < types.size(); type++) {
+      series_fit_t& result = results[a_item * types.size() + type];
+      result.index = index;
+      result.series_x = (a_options.select == table_select_t::row) ?
+        a_table.cell(index, 0) : a_table.cell(0, index);
+      result.type = types[type];
+      result.status = status;
+      result.points = data.x.size();
+      if (status == series_fit_status_t::not_enough_points) {
+        continue;
+      }
+      result.knots = data.knot_x.size();
+
+      interpolation_base_t& interpolation = *data.interpolations[type];
+      interpolation.set_points(data.knot_x.data(), data.knot_y.data(), data.knot_x.size());
+      data.calculated.resize(data.x.size());
+      interpolation.calc_array(data.x.data(), data.calculated.data(), data.x.size());
+      for (std::size_t i = 0; i < data.x.size(); i++) {
+        result.deviations.add(data.x[i], relative_deviation(data.y[i], data.calculated[i]));
+      }
+    }
+  });
+  if (cancelled) {
+    return std::vector<series_fit_t>();
+  }
+  return results;
+}
+
+std::string table_fit_report(const std::vector<series_fit_t>& a_results,
+  table_select_t a_select)
+{
+  std::string report = std::string(select_name(a_select)) + ";x;type;status;points;knots;"
+    "max_abs_deviation;max_abs_deviation_x;mean_abs_deviation;rms_deviation;"
+    "non_finite_deviations\n";
+  for (const series_fit_t& result: a_results) {
+    report += std::to_string(result.index) + ";" + format_number(result.series_x) + ";" +
+      interpolation_name(result.type) + ";" + series_fit_status_name(result.status) + ";" +
+      std::to_string(result.points) + ";" + std::to_string(result.knots);
+    if (result.status == series_fit_status_t::not_enough_points) {
+      report += ";;;;;\n";
+      continue;
+    }
+    const deviation_stats_t& deviations = result.deviations;
+    report += ";" + format_number(deviations.max_abs) + ";" +
+      format_number(deviations.max_abs_x) + ";" + format_number(deviations.mean_abs()) + ";" +
+      format_number(deviations.rms()) + ";" + std::to_string(deviations.non_finite) + "\n";
+  }
+  return report;
+}
+
+std::string table_fit_summary(const std::vector<series_fit_t>& a_results,
+  table_select_t a_select)
+{
+  std::string summary;
+  for (size_t type = 0; type < it_count; type++) {
+    std::size_t fitted = 0;
+    std::size_t ends_only = 0;
+    std::size_t not_fitted = 0;
+    std::size_t non_finite = 0;
+    const series_fit_t* worst = nullptr;
+    for (const series_fit_t& result: a_results) {
+      if (result.type != static_cast<interpolation_type_t>(type)) {
+        continue;
+      }
+      if (result.status == series_fit_status_t::not_enough_points) {
+        not_fitted++;
+        continue;
+      }
+      fitted++;
+      non_finite += result.deviations.non_finite;
+      if (result.status == series_fit_status_t::ends_only) {
+        ends_only++;
+      }
+      if (!worst || (result.deviations.max_abs > worst->deviations.max_abs)) {
+        worst = &result;
+      }
+    }
+    if ((fitted == 0) && (not_fitted == 0)) {
+      continue;
+    }
+    summary += std::string(interpolation_name(static_cast<interpolation_type_t>(type))) + ": " +
+      std::to_string(fitted) + " fitted, " + std::to_string(ends_only) + " on the ends only, " +
+      std::to_string(not_fitted) + " not fitted";
+    if (worst) {
+      summary += std::string(", worst ") + select_name(a_select) + " " +
+        std::to_string(worst->index) + " (x = " + format_number(worst->series_x) + "): " +
+        format_number(worst->deviations.max_abs) + "% at " +
+        format_number(worst->deviations.max_abs_x);
+    }
+    if (non_finite > 0) {
+      summary += ", " + std::to_string(non_finite) + " points without a finite deviation";
+    }
+    summary += "\n";
+  }
+  return summary;
+}
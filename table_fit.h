@@ -0,0 +1,97 @@
+#ifndef TABLE_FIT_H
+#define TABLE_FIT_H
+
+#include "fit_pipeline.h"
+#include "table_reader.h"
+
+#include <array>
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+struct table_fit_options_t
+{
+  table_select_t select;
+  //X of the knots. A series that lacks some of them is fitted on its
+  //first and last point, like the neighbours prefetched by the main window.
+  //Empty means that every point is a knot
+  std::vector<double> knots;
+  std::array<bool, it_count> enable;
+  //0 is all cores
+  std::size_t threads;
+  //Checked before every series, may be empty
+  std::function<bool()> is_cancelled;
+
+  table_fit_options_t():
+    select(table_select_t::row),
+    knots(),
+    enable(),
+    threads(0),
+    is_cancelled()
+  {
+  }
+};
+
+enum class series_fit_status_t {
+  ok,
+  //Some knots are not X of the series, it is fitted on its ends
+  ends_only,
+  //Less than two points remain after normalize_points
+  not_enough_points
+};
+
+struct series_fit_t
+{
+  //Row or column in the table, from 1
+  std::size_t index;
+  //X of the series: the first cell of the row or column
+  double series_x;
+  interpolation_type_t type;
+  series_fit_status_t status;
+  std::size_t points;
+  std::size_t knots;
+  deviation_stats_t deviations;
+
+  series_fit_t():
+    index(0),
+    series_x(0),
+    type(it_cubic),
+    status(series_fit_status_t::ok),
+    points(0),
+    knots(0),
+    deviations()
+  {
+  }
+};
+
+//Fits every row or column of a_table with every enabled interpolation
+//and calculates the deviations in all points of the series.
+//Series are distributed with for_each_stealing, so a few long series
+//do not hold the other threads. Results are ordered by series, then by type.
+//Returns an empty vector if a_options.is_cancelled reported true
+std::vector<series_fit_t> fit_table(const table_t& a_table, const table_fit_options_t& a_options);
+
+//What the table fit delivers to the main window
+struct table_fit_result_t
+{
+  std::string report;
+  std::string summary;
+
+  table_fit_result_t():
+    report(),
+    summary()
+  {
+  }
+};
+
+//Header and one ';' separated line per result
+std::string table_fit_report(const std::vector<series_fit_t>& a_results,
+  table_select_t a_select);
+//Counts and the worst series of every interpolation, one line per interpolation
+std::string table_fit_summary(const std::vector<series_fit_t>& a_results,
+  table_select_t a_select);
+
+const char* series_fit_status_name(series_fit_status_t a_status);
+
+#endif // TABLE_FIT_H
@@ -0,0 +1,322 @@
+#include "table_reader.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <limits>
+
+namespace {
+
+const double not_a_number = std::numeric_limits<double>::quiet_NaN();
+
+double parse_cell(const char* ap_begin, const char* ap_end)
+{
+  //strtod needs a terminated string with '.' as the separator
+  std::string cell(ap_begin, ap_end);
+  std::replace(cell.begin(), cell.end(), ',', '.');
+  const char* begin = cell.c_str();
+  char* end = nullptr;
+  double value = std::strtod(begin, &end);
+  while ((*end == ' ') || (*end == '\t') || (*end == '\r')) {
+    end++;
+  }
+  if ((end == begin) || (*end != '\0')) {
+    return not_a_number;
+  }
+  return value;
+}
+
+std::size_t csv_cell_count(const std::string& a_line)
+{
+  return static_cast<std::size_t>(std::count(a_line.begin(), a_line.end(), ';')) + 1;
+}
+
+//NaN if the line is shorter
+double csv_cell(const std::string& a_line, std::size_t a_index)
+{
+  std::size_t begin = 0;
+  for (std::size_t i = 0; i < a_index; i++) {
+    begin = a_line.find(';', begin);
+    if (begin == std::string::npos) {
+      return not_a_number;
+    }
+    begin++;
+  }
+  std::size_t end = std::min(a_line.find(';', begin), a_line.size());
+  return parse_cell(a_line.data() + begin, a_line.data() + end);
+}
+
+//All cells except the first one
+void csv_row_values(const std::string& a_line, std::vector<double>& a_values)
+{
+  a_values.clear();
+  std::size_t begin = a_line.find(';');
+  while (begin != std::string::npos) {
+    begin++;
+    std::size_t end = a_line.find(';', begin);
+    a_values.push_back(parse_cell(a_line.data() + begin,
+      a_line.data() + std::min(end, a_line.size())));
+    begin = end;
+  }
+}
+
+bool read_csv_series(const std::string& a_path, table_select_t a_select, std::size_t a_index,
+  std::vector<double>& a_x, std::vector<double>& a_y, std::string& a_error)
+{
+  std::ifstream file(a_path);
+  if (!file) {
+    a_error = "can't open " + a_path;
+    return false;
+  }
+  std::string line;
+  if (!std::getline(file, line)) {
+    a_error = "table is empty";
+    return false;
+  }
+
+  switch (a_select) {
+    case table_select_t::row: {
+      csv_row_values(line, a_x);
+      bool found = false;
+      for (std::size_t row = 1; std::getline(file, line); row++) {
+        if (row == a_index) {
+          csv_row_values(line, a_y);
+          found = true;
+          break;
+        }
+      }
+      if (!found) {
+        a_error = "row " + std::to_string(a_index) + " is not in the table";
+        return false;
+      }
+      //Missing cells of a short row are empty
+      std::size_t count = std::max(a_x.size(), a_y.size());
+      a_x.resize(count, not_a_number);
+      a_y.resize(count, not_a_number);
+    } break;
+    case table_select_t::col: {
+      if (a_index >= csv_cell_count(line)) {
+        a_error = "column " + std::to_string(a_index) + " is not in the table";
+        return false;
+      }
+      while (std::getline(file, line)) {
+        a_x.push_back(csv_cell(line, 0));
+        a_y.push_back(csv_cell(line, a_index));
+      }
+    } break;
+  }
+  return true;
+}
+
+const std::uint64_t binary_header_size = 2 * sizeof(std::uint64_t);
+
+//Reads rows and cols and checks that the file holds all the cells,
+//so that no buffer is ever sized from a corrupted header
+bool read_binary_header(std::ifstream& a_file, std::uint64_t& a_rows, std::uint64_t& a_cols,
+  std::string& a_error)
+{
+  std::uint64_t size[2] = { 0, 0 };
+  if (!a_file.read(reinterpret_cast<char*>(size), sizeof(size))) {
+    a_error = "table header is truncated";
+    return false;
+  }
+  a_rows = size[0];
+  a_cols = size[1];
+  a_file.seekg(0, std::ios::end);
+  const std::streamoff file_size = a_file.tellg();
+  a_file.seekg(static_cast<std::streamoff>(binary_header_size));
+  const std::uint64_t max_cells =
+    (std::numeric_limits<std::uint64_t>::max() - binary_header_size) / sizeof(double);
+  if ((file_size < 0) || ((a_cols != 0) && (a_rows > max_cells / a_cols)) ||
+    (a_rows * a_cols > std::numeric_limits<std::size_t>::max() / sizeof(double)) ||
+    (binary_header_size + a_rows * a_cols * sizeof(double) >
+      static_cast<std::uint64_t>(file_size))) {
+    a_error = "table is truncated";
+    return false;
+  }
+  return true;
+}
+
+bool read_binary_series(const std::string& a_path, table_select_t a_select, std::size_t a_index,
+  std::vector<double>& a_x, std::vector<double>& a_y, std::string& a_error)
+{
+  std::ifstream file(a_path, std::ios::binary);
+  if (!file) {
+    a_error = "can't open " + a_path;
+    return false;
+  }
+  std::uint64_t rows = 0;
+  std::uint64_t cols = 0;
+  if (!read_binary_header(file, rows, cols, a_error)) {
+    return false;
+  }
+  if ((rows == 0) || (cols == 0)) {
+    a_error = "table is empty";
+    return false;
+  }
+  if ((a_select == table_select_t::row) ? (a_index >= rows) : (a_index >= cols)) {
+    a_error = std::string(a_select == table_select_t::row ? "row " : "column ") +
+      std::to_string(a_index) + " is not in the table";
+    return false;
+  }
+
+  auto read_cells = [&](std::uint64_t a_row, std::uint64_t a_col, double* ap_dst,
+    std::uint64_t a_count) {
+    file.seekg(static_cast<std::streamoff>(binary_header_size +
+      (a_row * cols + a_col) * sizeof(double)));
+    return static_cast<bool>(file.read(reinterpret_cast<char*>(ap_dst),
+      static_cast<std::streamsize>(a_count * sizeof(double))));
+  };
+
+  bool ok = true;
+  switch (a_select) {
+    case table_select_t::row: {
+      a_x.resize(static_cast<std::size_t>(cols - 1));
+      a_y.resize(a_x.size());
+      ok = read_cells(0, 1, a_x.data(), cols - 1) && read_cells(a_index, 1, a_y.data(), cols - 1);
+    } break;
+    case table_select_t::col: {
+      a_x.resize(static_cast<std::size_t>(rows - 1));
+      a_y.resize(a_x.size());
+      for (std::uint64_t row = 1; ok && (row < rows); row++) {
+        ok = read_cells(row, 0, &a_x[row - 1], 1) && read_cells(row, a_index, &a_y[row - 1], 1);
+      }
+    } break;
+  }
+  if (!ok) {
+    a_error = "table is truncated";
+  }
+  return ok;
+}
+
+bool read_csv_table(const std::string& a_path, table_t& a_table, std::string& a_error)
+{
+  std::ifstream file(a_path);
+  if (!file) {
+    a_error = "can't open " + a_path;
+    return false;
+  }
+  //Rows are kept separately until the widest one is known
+  std::vector<std::vector<double>> rows;
+  std::string line;
+  std::vector<double> values;
+  std::vector<double> rest;
+  while (std::getline(file, line)) {
+    values.clear();
+    values.push_back(csv_cell(line, 0));
+    csv_row_values(line, rest);
+    values.insert(values.end(), rest.begin(), rest.end());
+    a_table.cols = std::max(a_table.cols, values.size());
+    rows.push_back(values);
+  }
+  if (rows.empty()) {
+    a_error = "table is empty";
+    return false;
+  }
+  a_table.rows = rows.size();
+  a_table.cells.assign(a_table.rows * a_table.cols, not_a_number);
+  for (std::size_t row = 0; row < rows.size(); row++) {
+    std::copy(rows[row].begin(), rows[row].end(), a_table.cells.begin() +
+      static_cast<std::ptrdiff_t>(row * a_table.cols));
+  }
+  return true;
+}
+
+bool read_binary_table(const std::string& a_path, table_t& a_table, std::string& a_error)
+{
+  std::ifstream file(a_path, std::ios::binary);
+  if (!file) {
+    a_error = "can't open " + a_path;
+    return false;
+  }
+  std::uint64_t rows = 0;
+  std::uint64_t cols = 0;
+  if (!read_binary_header(file, rows, cols, a_error)) {
+    return false;
+  }
+  a_table.rows = static_cast<std::size_t>(rows);
+  a_table.cols = static_cast<std::size_t>(cols);
+  a_table.cells.resize(a_table.rows * a_table.cols);
+  if (!file.read(reinterpret_cast<char*>(a_table.cells.data()),
+    static_cast<std::streamsize>(a_table.cells.size() * sizeof(double)))) {
+    a_error = "table is truncated";
+    return false;
+  }
+  return true;
+}
+
+} // namespace
+
+table_format_t table_format_from_path(const std::string& a_path)
+{
+  const std::string extension = ".csv";
+  if ((a_path.size() >= extension.size()) &&
+    std::equal(extension.rbegin(), extension.rend(), a_path.rbegin(),
+      [](char a_ext, char a_path_char) {
+        return a_ext == static_cast<char>(std::tolower(static_cast<unsigned char>(a_path_char)));
+      })) {
+    return table_format_t::csv;
+  }
+  return table_format_t::binary;
+}
+
+bool read_table_series(const std::string& a_path, table_format_t a_format,
+  table_select_t a_select, std::size_t a_index,
+  std::vector<double>& a_x, std::vector<double>& a_y, std::string& a_error)
+{
+  a_x.clear();
+  a_y.clear();
+  if (a_index == 0) {
+    a_error = "series 0 holds X, the first series is 1";
+    return false;
+  }
+  switch (a_format) {
+    case table_format_t::csv: {
+      return read_csv_series(a_path, a_select, a_index, a_x, a_y, a_error);
+    }
+    case table_format_t::binary: {
+      return read_binary_series(a_path, a_select, a_index, a_x, a_y, a_error);
+    }
+  }
+  return false;
+}
+
+bool read_table(const std::string& a_path, table_format_t a_format, table_t& a_table,
+  std::string& a_error)
+{
+  a_table = table_t();
+  switch (a_format) {
+    case table_format_t::csv: {
+      return read_csv_table(a_path, a_table, a_error);
+    }
+    case table_format_t::binary: {
+      return read_binary_table(a_path, a_table, a_error);
+    }
+  }
+  return false;
+}
+
+void table_series(const table_t& a_table, table_select_t a_select, std::size_t a_index,
+  std::vector<double>& a_x, std::vector<double>& a_y)
+{
+  a_x.clear();
+  a_y.clear();
+  switch (a_select) {
+    case table_select_t::row: {
+      //The first row holds X
+      for (std::size_t col = 1; col < a_table.cols; col++) {
+        a_x.push_back(a_table.cell(0, col));
+        a_y.push_back(a_table.cell(a_index, col));
+      }
+    } break;
+    case table_select_t::col: {
+      //The first column holds X
+      for (std::size_t row = 1; row < a_table.rows; row++) {
+        a_x.push_back(a_table.cell(row, 0));
+        a_y.push_back(a_table.cell(row, a_index));
+      }
+    } break;
+  }
+}
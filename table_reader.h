@@ -0,0 +1,66 @@
+#ifndef TABLE_READER_H
+#define TABLE_READER_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+//Qt free reading of the tables that the import dialog shows.
+//The layout is the same: the first row holds X of the rows,
+//the first column holds X of the columns, cell (0, 0) is unused
+
+enum class table_format_t {
+  //Cells separated by ';', ',' is accepted as the decimal separator
+  csv,
+  //uint64 rows, uint64 cols, then rows*cols doubles row by row,
+  //all in the native byte order
+  binary
+};
+
+enum class table_select_t {
+  row,
+  col
+};
+
+//Whole table in memory, cells row by row, NaN for empty and invalid ones
+struct table_t
+{
+  std::size_t rows;
+  std::size_t cols;
+  std::vector<double> cells;
+
+  table_t():
+    rows(0),
+    cols(0),
+    cells()
+  {
+  }
+
+  double cell(std::size_t a_row, std::size_t a_col) const
+  {
+    return cells[a_row * cols + a_col];
+  }
+};
+
+//.csv is csv, everything else is binary
+table_format_t table_format_from_path(const std::string& a_path);
+
+//Reads one row or column, a_index counts from 0 like the table itself,
+//so the first series is 1. The file is streamed and only the selected
+//series is kept, the table may be larger than the memory.
+//Empty and invalid cells become NaN, normalize_points drops them.
+//Returns false and a_error on failure
+bool read_table_series(const std::string& a_path, table_format_t a_format,
+  table_select_t a_select, std::size_t a_index,
+  std::vector<double>& a_x, std::vector<double>& a_y, std::string& a_error);
+
+//Reads the whole table, short CSV rows are padded with NaN
+bool read_table(const std::string& a_path, table_format_t a_format, table_t& a_table,
+  std::string& a_error);
+
+//Same series as read_table_series, from a table in memory.
+//a_index must be in the table and not 0
+void table_series(const table_t& a_table, table_select_t a_select, std::size_t a_index,
+  std::vector<double>& a_x, std::vector<double>& a_y);
+
+#endif // TABLE_READER_H
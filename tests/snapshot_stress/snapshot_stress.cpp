@@ -0,0 +1,258 @@
+#include "curve_snapshot.h"
+#include "spline.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <thread>
+#include <vector>
+
+//Readers evaluate a curve_handle_t through curve_view_t at full speed while
+//a writer refits and publishes it continuously. Every value is checked
+//against the curve of the snapshot version it came from, the reader latency
+//percentiles are printed at the end. Exits with 1 on any inconsistent value
+
+namespace {
+
+const char* const usage_text =
+  "Usage: snapshot_stress [--seconds S] [--readers N] [--knots K]\n"
+  "  --seconds S   duration of the run (3)\n"
+  "  --readers N   reader threads (all cores but one, at least 1)\n"
+  "  --knots K     knots of every refit, at least 4 (200)\n";
+
+const std::size_t max_readers = 256;
+
+//Latencies are counted per nanosecond up to 1 ms, slower ones in the last bucket
+const std::size_t latency_buckets = 1000000;
+
+struct options_t
+{
+  double seconds;
+  std::size_t readers;
+  std::size_t knots;
+
+  options_t():
+    seconds(3),
+    readers(std::max(1u, std::thread::hardware_concurrency()) - 1),
+    knots(200)
+  {
+    readers = std::max<std::size_t>(readers, 1);
+  }
+};
+
+struct reader_result_t
+{
+  std::vector<std::uint64_t> latencies;
+  std::uint64_t evaluations;
+  std::uint64_t mismatches;
+  std::uint64_t version_regressions;
+  double worst_mismatch;
+
+  reader_result_t():
+    latencies(latency_buckets, 0),
+    evaluations(0),
+    mismatches(0),
+    version_regressions(0),
+    worst_mismatch(0)
+  {
+  }
+};
+
+//Every version fits samples of its own cubic. A not-a-knot spline
+//reproduces a cubic exactly, so the reference does not depend on the knots
+void cubic_coeffs(std::uint64_t a_version, double* a_c)
+{
+  a_c[0] = static_cast<double>(a_version % 1000);
+  a_c[1] = static_cast<double>((a_version * 7) % 13) - 6;
+  a_c[2] = static_cast<double>((a_version * 5) % 11) - 5;
+  a_c[3] = static_cast<double>((a_version * 3) % 7) - 3;
+}
+
+double reference_value(std::uint64_t a_version, double a_x)
+{
+  double c[4];
+  cubic_coeffs(a_version, c);
+  return c[0] + a_x * (c[1] + a_x * (c[2] + a_x * c[3]));
+}
+
+//Knots move with the version, so a snapshot torn between two fits
+//would not match either reference. The ends stay at 0 and 1
+void make_points(std::uint64_t a_version, std::vector<double>& a_x, std::vector<double>& a_y)
+{
+  const std::size_t count = a_x.size();
+  for (std::size_t i = 0; i < count; i++) {
+    double t = static_cast<double>(i);
+    if ((i > 0) && (i + 1 < count)) {
+      t += 0.4 * std::sin(0.7 * static_cast<double>(a_version) + t);
+    }
+    a_x[i] = t / static_cast<double>(count - 1);
+    a_y[i] = reference_value(a_version, a_x[i]);
+  }
+}
+
+void run_writer(curve_handle_t& a_handle, std::size_t a_knots, const std::atomic<bool>& a_stop,
+  std::uint64_t& a_refits)
+{
+  std::vector<double> x(a_knots);
+  std::vector<double> y(a_knots);
+  std::uint64_t version = 1;
+  do {
+    make_points(version, x, y);
+    tk::spline spline;
+    spline.set_boundary(tk::spline::not_a_knot, 0, tk::spline::not_a_knot, 0);
+    spline.set_points(x.data(), y.data(), a_knots);
+    a_handle.publish(make_curve_snapshot(spline, version));
+    version++;
+  } while (!a_stop.load(std::memory_order_relaxed));
+  a_refits = version - 1;
+}
+
+void run_reader(const curve_handle_t& a_handle, unsigned a_seed, const std::atomic<bool>& a_stop,
+  reader_result_t& a_result)
+{
+  typedef std::chrono::steady_clock steady_clock_t;
+  curve_view_t view(a_handle);
+  std::mt19937_64 random(a_seed);
+  std::uniform_real_distribution<double> distribution(0, 1);
+  std::uint64_t last_version = 0;
+  while (!a_stop.load(std::memory_order_relaxed)) {
+    const double x = distribution(random);
+    const steady_clock_t::time_point start = steady_clock_t::now();
+    const curve_snapshot_t* snapshot = view.snapshot();
+    const double y = snapshot ? (*snapshot)(x) : 0;
+    const steady_clock_t::time_point finish = steady_clock_t::now();
+    if (!snapshot) {
+      continue;
+    }
+    const std::uint64_t nanoseconds = static_cast<std::uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(finish - start).count());
+    a_result.latencies[std::min<std::uint64_t>(nanoseconds, latency_buckets - 1)]++;
+    a_result.evaluations++;
+
+    const double reference = reference_value(snapshot->version(), x);
+    const double error = std::abs(y - reference);
+    if (!(error <= 1e-8 * (1 + std::abs(reference)))) {
+      a_result.mismatches++;
+      a_result.worst_mismatch = std::max(a_result.worst_mismatch, error);
+    }
+    if (snapshot->version() < last_version) {
+      a_result.version_regressions++;
+    }
+    last_version = snapshot->version();
+  }
+}
+
+std::uint64_t latency_percentile(const std::vector<std::uint64_t>& a_latencies,
+  std::uint64_t a_total, double a_fraction)
+{
+  const std::uint64_t rank = static_cast<std::uint64_t>(
+    std::ceil(a_fraction * static_cast<double>(a_total)));
+  std::uint64_t seen = 0;
+  for (std::size_t i = 0; i < a_latencies.size(); i++) {
+    seen += a_latencies[i];
+    if ((seen >= rank) && (seen > 0)) {
+      return i;
+    }
+  }
+  return a_latencies.size() - 1;
+}
+
+bool parse_options(int a_argc, char** a_argv, options_t& a_options)
+{
+  for (int i = 1; i < a_argc; i++) {
+    if (i + 1 >= a_argc) {
+      return false;
+    }
+    char* end = nullptr;
+    if (std::strcmp(a_argv[i], "--seconds") == 0) {
+      a_options.seconds = std::strtod(a_argv[++i], &end);
+      if (!(a_options.seconds > 0)) {
+        return false;
+      }
+    } else if (std::strcmp(a_argv[i], "--readers") == 0) {
+      a_options.readers = std::strtoul(a_argv[++i], &end, 10);
+      if ((a_options.readers == 0) || (a_options.readers > max_readers)) {
+        return false;
+      }
+    } else if (std::strcmp(a_argv[i], "--knots") == 0) {
+      a_options.knots = std::strtoul(a_argv[++i], &end, 10);
+      if (a_options.knots < 4) {
+        return false;
+      }
+    } else {
+      return false;
+    }
+    if (*end != '\0') {
+      return false;
+    }
+  }
+  return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+  options_t options;
+  if (!parse_options(argc, argv, options)) {
+    std::fputs(usage_text, stderr);
+    return 2;
+  }
+
+  curve_handle_t handle;
+  std::atomic<bool> stop(false);
+  std::uint64_t refits = 0;
+  std::vector<reader_result_t> results(options.readers);
+  std::vector<std::thread> readers;
+  for (std::size_t i = 0; i < options.readers; i++) {
+    readers.emplace_back(run_reader, std::cref(handle), static_cast<unsigned>(i + 1),
+      std::cref(stop), std::ref(results[i]));
+  }
+  std::thread writer(run_writer, std::ref(handle), options.knots, std::cref(stop),
+    std::ref(refits));
+
+  std::this_thread::sleep_for(std::chrono::duration<double>(options.seconds));
+  stop.store(true);
+  writer.join();
+  for (std::thread& reader: readers) {
+    reader.join();
+  }
+
+  reader_result_t total;
+  for (const reader_result_t& result: results) {
+    for (std::size_t i = 0; i < latency_buckets; i++) {
+      total.latencies[i] += result.latencies[i];
+    }
+    total.evaluations += result.evaluations;
+    total.mismatches += result.mismatches;
+    total.version_regressions += result.version_regressions;
+    total.worst_mismatch = std::max(total.worst_mismatch, result.worst_mismatch);
+  }
+
+  std::printf("readers %zu, knots %zu, %.1f s\n", options.readers, options.knots,
+    options.seconds);
+  std::printf("refits %llu, evaluations %llu\n", static_cast<unsigned long long>(refits),
+    static_cast<unsigned long long>(total.evaluations));
+  std::printf("inconsistent values %llu (worst error %g), version regressions %llu\n",
+    static_cast<unsigned long long>(total.mismatches), total.worst_mismatch,
+    static_cast<unsigned long long>(total.version_regressions));
+  if (total.evaluations > 0) {
+    //Includes the snapshot check and the clock overhead
+    std::printf("reader latency ns: p50 %llu, p99 %llu, p99.9 %llu\n",
+      static_cast<unsigned long long>(latency_percentile(total.latencies, total.evaluations, 0.5)),
+      static_cast<unsigned long long>(latency_percentile(total.latencies, total.evaluations, 0.99)),
+      static_cast<unsigned long long>(
+        latency_percentile(total.latencies, total.evaluations, 0.999)));
+  }
+
+  const bool ok = (total.mismatches == 0) && (total.version_regressions == 0) &&
+    (total.evaluations > 0) && (refits > 1);
+  std::printf("%s\n", ok ? "passed" : "FAILED");
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,34 @@
+#-------------------------------------------------
+#
+# Stress test of curve_handle_t: readers at full
+# speed during continuous refits, prints the reader
+# latency percentiles, exits with 1 on failure
+#
+#-------------------------------------------------
+
+TARGET = snapshot_stress
+TEMPLATE = app
+
+CONFIG += console c++17
+CONFIG -= qt app_bundle
+
+INCLUDEPATH += ../..
+
+SOURCES += \
+        snapshot_stress.cpp \
+        ../../curve_snapshot.cpp \
+        ../../input_normalization.cpp \
+        ../../instrumentation.cpp \
+        ../../spline.cpp
+
+HEADERS += \
+        ../../curve_snapshot.h \
+        ../../input_normalization.h \
+        ../../instrumentation.h \
+        ../../interpolation_base.h \
+        ../../inverse_search.h \
+        ../../piecewise_cubic.h \
+        ../../segment_search.h \
+        ../../spline.h
+
+unix: LIBS += -pthread
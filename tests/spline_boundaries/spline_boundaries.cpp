@@ -0,0 +1,238 @@
+#include "spline.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <vector>
+
+//Checks of the tk::spline boundary conditions and a timing loop per bd_type.
+//Exits with 1 if any check fails
+
+namespace {
+
+const double pi = 3.14159265358979323846;
+
+int g_failures = 0;
+
+void check(bool a_ok, const char* a_what, double a_error)
+{
+  std::printf("%-44s %s (error %.3g)\n", a_what, a_ok ? "ok" : "FAILED", a_error);
+  if (!a_ok) {
+    g_failures++;
+  }
+}
+
+//Irregular knots, so that a uniform grid does not hide index errors
+std::vector<double> make_knots(std::size_t a_count, double a_min, double a_max)
+{
+  std::vector<double> x(a_count);
+  for (std::size_t i = 0; i < a_count; i++) {
+    const double t = static_cast<double>(i) / static_cast<double>(a_count - 1);
+    x[i] = a_min + (a_max - a_min) * (t + 0.3 * t * (1 - t) * std::sin(7 * t));
+  }
+  return x;
+}
+
+double cubic(double a_x)
+{
+  return 1.5 - 2 * a_x + 0.75 * a_x * a_x - 0.125 * a_x * a_x * a_x;
+}
+
+double cubic_first(double a_x)
+{
+  return -2 + 1.5 * a_x - 0.375 * a_x * a_x;
+}
+
+double cubic_second(double a_x)
+{
+  return 1.5 - 0.75 * a_x;
+}
+
+void check_not_a_knot()
+{
+  const std::vector<double> x = make_knots(12, -2, 5);
+  std::vector<double> y(x.size());
+  for (std::size_t i = 0; i < x.size(); i++) {
+    y[i] = cubic(x[i]);
+  }
+  tk::spline s;
+  s.set_boundary(tk::spline::not_a_knot, 0, tk::spline::not_a_knot, 0);
+  s.set_points(x.data(), y.data(), x.size());
+
+  double value_error = 0;
+  double first_error = 0;
+  double second_error = 0;
+  for (double t = x.front(); t <= x.back(); t += 0.01) {
+    const interpolation_derivs_t derivs = s.calc_derivs(t);
+    value_error = std::max(value_error, std::abs(derivs.value - cubic(t)));
+    first_error = std::max(first_error, std::abs(derivs.first - cubic_first(t)));
+    second_error = std::max(second_error, std::abs(derivs.second - cubic_second(t)));
+  }
+  check(value_error < 1e-10, "not_a_knot reproduces a cubic", value_error);
+  check(first_error < 1e-9, "not_a_knot reproduces f'", first_error);
+  check(second_error < 1e-9, "not_a_knot reproduces f''", second_error);
+
+  //A mixed spline keeps f''' continuous in the second knot
+  tk::spline mixed;
+  mixed.set_boundary(tk::spline::not_a_knot, 0, tk::spline::second_deriv, 0);
+  std::vector<double> noisy(y);
+  for (std::size_t i = 0; i < noisy.size(); i++) {
+    noisy[i] += 0.1 * std::sin(3.0 * static_cast<double>(i));
+  }
+  mixed.set_points(x.data(), noisy.data(), x.size());
+  const double jump = std::abs(mixed.deriv(3, x[1] - 1e-9) - mixed.deriv(3, x[1] + 1e-9));
+  check(jump < 1e-6, "not_a_knot f''' continuous in x[1]", jump);
+}
+
+void check_periodic()
+{
+  const double period = 2 * pi;
+  const std::vector<double> x = make_knots(17, 0, period);
+  std::vector<double> y(x.size());
+  for (std::size_t i = 0; i < x.size(); i++) {
+    y[i] = std::sin(x[i]) + 0.5 * std::cos(2 * x[i]);
+  }
+  tk::spline s;
+  s.set_boundary(tk::spline::periodic, 0, tk::spline::periodic, 0);
+  s.set_points(x.data(), y.data(), x.size());
+
+  //Last interval in its right end against the first one in its left end
+  piecewise_cubic_t curve;
+  s.export_piecewise(curve);
+  const std::size_t n = x.size();
+  const double* first = curve.coeffs.data() + piecewise_cubic_t::coeffs_per_segment;
+  const double* last = curve.coeffs.data() + (n - 1) * piecewise_cubic_t::coeffs_per_segment;
+  const double h = x[n - 1] - x[n - 2];
+  const double value_jump = std::abs(last[0] + h * (last[1] + h * (last[2] + h * last[3])) -
+    first[0]);
+  const double first_jump = std::abs(last[1] + h * (2 * last[2] + 3 * h * last[3]) - first[1]);
+  const double second_jump = std::abs(2 * last[2] + 6 * h * last[3] - 2 * first[2]);
+  check(value_jump < 1e-12, "periodic f continuous across the wrap", value_jump);
+  check(first_jump < 1e-10, "periodic f' continuous across the wrap", first_jump);
+  check(second_jump < 1e-9, "periodic f'' continuous across the wrap", second_jump);
+
+  double wrap_error = 0;
+  for (double t = -3 * period; t < 3 * period; t += 0.37) {
+    wrap_error = std::max(wrap_error, std::abs(s(t) - s(t + period)));
+  }
+  check(wrap_error < 1e-9, "periodic f(x) == f(x + period)", wrap_error);
+
+  //Just below a multiple of the period the wrap gives almost a whole period,
+  //the count of whole periods must agree with it
+  const double short_period = 0.1;
+  const std::vector<double> short_x = make_knots(11, 0, short_period);
+  std::vector<double> short_y(short_x.size());
+  for (std::size_t i = 0; i < short_x.size(); i++) {
+    short_y[i] = 1 + std::sin(2 * pi * short_x[i] / short_period);
+  }
+  tk::spline short_s;
+  short_s.set_boundary(tk::spline::periodic, 0, tk::spline::periodic, 0);
+  short_s.set_points(short_x.data(), short_y.data(), short_x.size());
+  const double period_integral = short_s.integrate(0, short_period);
+  double multiple_error = 0;
+  for (int k = 1; k < 2000; k++) {
+    double t = k * short_period;
+    for (int step = 0; step < 4; step++) {
+      t = std::nextafter(t, 0.0);
+      multiple_error = std::max(multiple_error,
+        std::abs(short_s.integrate(0, t) - k * period_integral));
+    }
+  }
+  check(multiple_error < 1e-9, "periodic integral near multiples of period", multiple_error);
+}
+
+void check_derivative_boundaries()
+{
+  const std::vector<double> x = make_knots(9, 0, 4);
+  std::vector<double> y(x.size());
+  for (std::size_t i = 0; i < x.size(); i++) {
+    y[i] = std::exp(-x[i]) * std::cos(3 * x[i]);
+  }
+  const double left_value = 2.5;
+  const double right_value = -0.75;
+
+  tk::spline first;
+  first.set_boundary(tk::spline::first_deriv, left_value, tk::spline::first_deriv, right_value);
+  first.set_points(x.data(), y.data(), x.size());
+  const double first_error = std::max(std::abs(first.deriv(1, x.front()) - left_value),
+    std::abs(first.deriv(1, x.back()) - right_value));
+  check(first_error < 1e-10, "first_deriv matches the boundary values", first_error);
+
+  tk::spline second;
+  second.set_boundary(tk::spline::second_deriv, left_value, tk::spline::second_deriv,
+    right_value);
+  second.set_points(x.data(), y.data(), x.size());
+  const double second_error = std::max(std::abs(second.deriv(2, x.front()) - left_value),
+    std::abs(second.deriv(2, x.back()) - right_value));
+  check(second_error < 1e-10, "second_deriv matches the boundary values", second_error);
+
+  double knot_error = 0;
+  for (std::size_t i = 0; i < x.size(); i++) {
+    knot_error = std::max(knot_error, std::abs(first(x[i]) - y[i]));
+    knot_error = std::max(knot_error, std::abs(second(x[i]) - y[i]));
+  }
+  check(knot_error < 1e-12, "first/second_deriv pass through the knots", knot_error);
+}
+
+double elapsed_ms(std::chrono::steady_clock::time_point a_start)
+{
+  return std::chrono::duration<double, std::milli>(
+    std::chrono::steady_clock::now() - a_start).count();
+}
+
+void benchmark(const char* a_name, tk::spline::bd_type a_type)
+{
+  const std::size_t points = 100000;
+  const std::size_t queries = 1000000;
+  const int repeats = 10;
+  const double period = 2 * pi;
+  const std::vector<double> x = make_knots(points, 0, period);
+  std::vector<double> y(points);
+  for (std::size_t i = 0; i < points; i++) {
+    y[i] = std::sin(x[i]);
+  }
+  std::vector<double> qx(queries);
+  std::vector<double> qy(queries);
+  for (std::size_t i = 0; i < queries; i++) {
+    qx[i] = period * static_cast<double>(i) / static_cast<double>(queries);
+  }
+
+  double fit_ms = 0;
+  double eval_ms = 0;
+  double checksum = 0;
+  for (int r = 0; r < repeats; r++) {
+    tk::spline s;
+    s.set_boundary(a_type, 0, a_type, 0);
+    auto start = std::chrono::steady_clock::now();
+    s.set_points(x.data(), y.data(), points);
+    fit_ms += elapsed_ms(start);
+    start = std::chrono::steady_clock::now();
+    s.calc_array(qx.data(), qy.data(), queries);
+    eval_ms += elapsed_ms(start);
+    checksum += qy[queries / 3];
+  }
+  std::printf("%-13s fit %zu points %8.3f ms, calc_array %zu points %8.3f ms (%g)\n",
+    a_name, points, fit_ms / repeats, queries, eval_ms / repeats, checksum);
+}
+
+} // namespace
+
+int main()
+{
+  check_not_a_knot();
+  check_periodic();
+  check_derivative_boundaries();
+
+  benchmark("first_deriv", tk::spline::first_deriv);
+  benchmark("second_deriv", tk::spline::second_deriv);
+  benchmark("not_a_knot", tk::spline::not_a_knot);
+  benchmark("periodic", tk::spline::periodic);
+
+  if (g_failures > 0) {
+    std::printf("%d check(s) failed\n", g_failures);
+    return 1;
+  }
+  std::printf("all checks passed\n");
+  return 0;
+}
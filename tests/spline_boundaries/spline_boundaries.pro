@@ -0,0 +1,29 @@
+#-------------------------------------------------
+#
+# Checks of the tk::spline boundary conditions and
+# a timing loop per bd_type, exits with 1 on failure
+#
+#-------------------------------------------------
+
+TARGET = spline_boundaries
+TEMPLATE = app
+
+CONFIG += console c++17
+CONFIG -= qt app_bundle
+
+INCLUDEPATH += ../..
+
+SOURCES += \
+        spline_boundaries.cpp \
+        ../../input_normalization.cpp \
+        ../../instrumentation.cpp \
+        ../../spline.cpp
+
+HEADERS += \
+        ../../input_normalization.h \
+        ../../instrumentation.h \
+        ../../interpolation_base.h \
+        ../../inverse_search.h \
+        ../../piecewise_cubic.h \
+        ../../segment_search.h \
+        ../../spline.h